@@ -0,0 +1,365 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef ADAPTIVEPQ_H
+#define ADAPTIVEPQ_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+#include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+#include "PQSnapshot.hpp"
+#include "SortedPQ.hpp"
+#include "UnorderedFastPQ.hpp"
+
+// The vector-backed engines an AdaptivePQ can run on.
+enum class AdaptiveEngine {
+    Unordered,  // UnorderedFastPQ: O(1) push, O(n) pop; push-heavy queues
+    Sorted,     // SortedPQ: O(n) push, O(1) pop; pop-heavy after a bulk load
+    Binary,     // BinaryPQ: O(log n) both; everything in between
+};
+
+
+// A priority queue that watches its own operation mix and moves its
+// contents to whichever vector-backed engine suits that mix best.
+//
+// Every push, pop, top and updatePriorities is counted. After each window
+// of operations the counts are folded into an exponentially decaying
+// history (so older windows fade out), and a cost model estimates what the
+// recent mix would have cost on each engine at the current size. The queue
+// migrates only when another engine wins clearly (by kMargin), wins for
+// kStreak windows in a row, and would pay back the cost of migrating
+// before the mix is likely to change; that hysteresis keeps a mix near a
+// boundary from bouncing between engines. The streak is waived when the
+// current engine wastes many migrations' worth of work per history, as
+// UnorderedFastPQ does once pops start on a large queue.
+//
+// Migrating moves the engine's std::vector into the new engine rather than
+// re-pushing its elements, and tells it how they are already arranged: a
+// sorted vector reversed is a heap, and a heap or sorted vector tells
+// UnorderedFastPQ where its most extreme element is. Only a move into
+// SortedPQ, or into BinaryPQ from no order, has to reorder anything.
+//
+// A new PQ starts on BinaryPQ. INSTRUMENT is an instrumentation policy (see
+// PQInstrument.hpp); its counts follow the elements from engine to engine.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+class AdaptivePQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Description: Construct an empty PQ with an optional comparison functor.
+    // Runtime: O(1)
+    explicit AdaptivePQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : BaseClass { comp }
+        , unordered { comp }
+        , sorted { comp }
+        , binary { comp } {}
+
+
+    // Description: Construct a PQ out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    AdaptivePQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : BaseClass { comp }
+        , unordered { comp }
+        , sorted { comp }
+        , binary { start, end, comp } {}
+
+
+    virtual ~AdaptivePQ() = default;
+
+
+    // Description: Add a new element to the PQ.
+    // Runtime: that of the current engine, plus an occasional migration
+    virtual void push(const TYPE &val) {
+        ++window.pushes;
+        visit([&val](auto &pq) { pq.push(val); });
+        endOperation();
+    }  // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element
+    //              from the PQ.
+    // Runtime: that of the current engine, plus an occasional migration
+    virtual void pop() {
+        ++window.pops;
+        visit([](auto &pq) { pq.pop(); });
+        endOperation();
+    }  // pop()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the PQ.
+    // Runtime: that of the current engine
+    virtual const TYPE &top() const {
+        ++window.tops;
+        return visit([](const auto &pq) -> const TYPE & { return pq.top(); });
+    }  // top()
+
+
+    // Description: Get the number of elements in the PQ.
+    // Runtime: O(1)
+    [[nodiscard]] virtual std::size_t size() const {
+        return visit([](const auto &pq) { return pq.size(); });
+    }  // size()
+
+
+    // Description: Return true if the PQ is empty.
+    // Runtime: O(1)
+    [[nodiscard]] virtual bool empty() const { return size() == 0; }
+
+
+    // Description: Assumes that all elements inside the PQ are out of order and
+    //              'rebuilds' the PQ by fixing the current engine's invariant.
+    // Runtime: that of the current engine
+    virtual void updatePriorities() {
+        ++window.updates;
+        visit([](auto &pq) { pq.updatePriorities(); });
+        endOperation();
+    }  // updatePriorities()
+
+
+    // Description: The engine currently holding the elements.
+    // Runtime: O(1)
+    [[nodiscard]] AdaptiveEngine engine() const { return active; }
+
+
+    // Description: How many times the PQ has changed engines.
+    // Runtime: O(1)
+    [[nodiscard]] std::size_t migrationCount() const { return migrations; }
+
+
+    // Description: Move the elements to 'target' now, regardless of the
+    //              operation mix. Adaptation carries on afterwards unless it
+    //              was turned off with setAdaptive(false).
+    // Runtime: O(n log(n)) into SortedPQ, O(n) into BinaryPQ, else O(1)
+    void migrateTo(AdaptiveEngine target) {
+        if (target == active) return;
+
+        SnapshotKind arrangement = arrangementOf(active);
+        std::vector<TYPE> elements = visit([](auto &pq) { return pq.releaseData(); });
+        if (active == AdaptiveEngine::Sorted && target == AdaptiveEngine::Binary) {
+            // Most extreme first is a valid heap.
+            std::reverse(elements.begin(), elements.end());
+            arrangement = SnapshotKind::Heap;
+        }  // if
+        std::swap(instrumentOf(active), instrumentOf(target));
+
+        active = target;
+        visit([&elements, arrangement](auto &pq) { pq.adoptData(std::move(elements), arrangement); });
+        ++migrations;
+        candidate = active;
+        streak = 0;
+    }  // migrateTo()
+
+
+    // Description: Turn automatic migration on or off (it is on by default).
+    // Runtime: O(1)
+    void setAdaptive(bool enabled) { adaptive = enabled; }
+
+
+    // Description: Set how many operations make up one window; the engine
+    //              is only reconsidered at the end of a window.
+    // Runtime: O(1)
+    void setWindow(std::size_t operations) { windowSize = std::max<std::size_t>(1, operations); }
+
+
+    // Description: Access the instrumentation policy, e.g. to dump() or
+    //              reset() a CountingInstrument.
+    // Runtime: O(1)
+    const INSTRUMENT &instrumentation() const {
+        return visit([](const auto &pq) -> const INSTRUMENT & { return pq.instrumentation(); });
+    }  // instrumentation()
+    INSTRUMENT &instrumentation() { return instrumentOf(active); }
+
+
+private:
+    // Operation counts for one window, or the decayed history of them.
+    struct Mix {
+        double pushes = 0;
+        double pops = 0;
+        double tops = 0;
+        double updates = 0;
+        double sizes = 0;  // sum of the size after each counted operation
+        double operations = 0;
+    };  // Mix
+
+    // Another engine must be this much cheaper to be considered.
+    static constexpr double kMargin = 0.25;
+    // ... and win this many windows in a row ...
+    static const unsigned kStreak = 2;
+    // ... unless staying put wastes this many migrations' worth of work.
+    static constexpr double kUrgent = 4.0;
+    // ... and pay back the migration in time: within as many operations as
+    // there are elements, or this many histories' worth of operations (a
+    // history weighs about two windows), whichever is more.
+    static constexpr double kPayback = 2.0;
+    // What moving one element costs relative to one comparison.
+    static constexpr double kMoveCost = 0.1;
+
+    UnorderedFastPQ<TYPE, COMP_FUNCTOR, INSTRUMENT> unordered;
+    SortedPQ<TYPE, COMP_FUNCTOR, INSTRUMENT> sorted;
+    BinaryPQ<TYPE, COMP_FUNCTOR, INSTRUMENT> binary;
+    AdaptiveEngine active = AdaptiveEngine::Binary;
+
+    // Mutable so that top() can be counted.
+    mutable Mix window;
+    Mix history;
+    std::size_t windowSize = 512;
+    bool adaptive = true;
+
+    AdaptiveEngine candidate = AdaptiveEngine::Binary;
+    unsigned streak = 0;
+    std::size_t migrations = 0;
+
+
+    // Description: Call fn on the active engine and return what it returns.
+    template<typename FUNCTION>
+    decltype(auto) visit(FUNCTION fn) {
+        switch (active) {
+        case AdaptiveEngine::Unordered:
+            return fn(unordered);
+        case AdaptiveEngine::Sorted:
+            return fn(sorted);
+        case AdaptiveEngine::Binary:
+        default:
+            return fn(binary);
+        }  // switch
+    }  // visit()
+
+    template<typename FUNCTION>
+    decltype(auto) visit(FUNCTION fn) const {
+        switch (active) {
+        case AdaptiveEngine::Unordered:
+            return fn(unordered);
+        case AdaptiveEngine::Sorted:
+            return fn(sorted);
+        case AdaptiveEngine::Binary:
+        default:
+            return fn(binary);
+        }  // switch
+    }  // visit()
+
+
+    INSTRUMENT &instrumentOf(AdaptiveEngine engine) {
+        switch (engine) {
+        case AdaptiveEngine::Unordered:
+            return unordered.instrumentation();
+        case AdaptiveEngine::Sorted:
+            return sorted.instrumentation();
+        case AdaptiveEngine::Binary:
+        default:
+            return binary.instrumentation();
+        }  // switch
+    }  // instrumentOf()
+
+
+    // Description: How an engine leaves its vector, for the next one.
+    static SnapshotKind arrangementOf(AdaptiveEngine engine) {
+        switch (engine) {
+        case AdaptiveEngine::Sorted:
+            return SnapshotKind::Sorted;
+        case AdaptiveEngine::Binary:
+            return SnapshotKind::Heap;
+        case AdaptiveEngine::Unordered:
+        default:
+            return SnapshotKind::Unordered;
+        }  // switch
+    }  // arrangementOf()
+
+
+    // Description: Count the operation just done and, at the end of a
+    //              window, reconsider the engine.
+    void endOperation() {
+        window.sizes += static_cast<double>(size());
+        if (++window.operations < static_cast<double>(windowSize)) return;
+
+        history.pushes = history.pushes / 2 + window.pushes;
+        history.pops = history.pops / 2 + window.pops;
+        history.tops = history.tops / 2 + window.tops;
+        history.updates = history.updates / 2 + window.updates;
+        history.sizes = history.sizes / 2 + window.sizes;
+        history.operations = history.operations / 2 + window.operations;
+        window = Mix {};
+        if (adaptive) reconsider();
+    }  // endOperation()
+
+
+    // Description: Estimated comparisons (plus weighted moves) for the
+    //              history's operations on 'engine' at size n.
+    static double costOf(AdaptiveEngine engine, const Mix &mix, double n) {
+        const double lg = std::log2(n + 2);
+        switch (engine) {
+        case AdaptiveEngine::Unordered:
+            // One scan serves a top() and the pop() after it.
+            return mix.pushes + std::max(mix.pops, mix.tops) * n + mix.updates;
+        case AdaptiveEngine::Sorted:
+            // Binary search, then shift half the vector on average.
+            return mix.pushes * (lg + kMoveCost * n / 2) + mix.pops + mix.tops
+                   + mix.updates * n * lg;
+        case AdaptiveEngine::Binary:
+        default:
+            // A random push sifts up about two levels.
+            return mix.pushes * 2 + mix.pops * 2 * lg + mix.tops + mix.updates * 2 * n;
+        }  // switch
+    }  // costOf()
+
+
+    // Description: Estimated cost of moving n elements from the active
+    //              engine to 'target'.
+    double migrationCost(AdaptiveEngine target, double n) const {
+        switch (target) {
+        case AdaptiveEngine::Sorted:
+            return n * std::log2(n + 2);
+        case AdaptiveEngine::Binary:
+            return active == AdaptiveEngine::Sorted ? kMoveCost * n : 2 * n;
+        case AdaptiveEngine::Unordered:
+        default:
+            return 0;
+        }  // switch
+    }  // migrationCost()
+
+
+    // Description: Pick the cheapest engine for the recent mix and migrate
+    //              to it if it has clearly won for long enough.
+    void reconsider() {
+        const double n = history.sizes / std::max(1.0, history.operations);
+        AdaptiveEngine best = active;
+        double bestCost = costOf(active, history, n);
+        const double currentCost = bestCost;
+        for (AdaptiveEngine engine : { AdaptiveEngine::Unordered, AdaptiveEngine::Sorted,
+                                       AdaptiveEngine::Binary }) {
+            const double cost = costOf(engine, history, n);
+            if (cost < bestCost) {
+                best = engine;
+                bestCost = cost;
+            }  // if
+        }  // for ..engine
+
+        // A queue that is mostly being drained or filled keeps that up for
+        // about as many operations as it holds elements.
+        const double horizon = std::max(n, history.operations * kPayback);
+        const double savedPerOperation = (currentCost - bestCost) / history.operations;
+        const bool worthIt = best != active && bestCost < currentCost * (1 - kMargin)
+                             && savedPerOperation * horizon > migrationCost(best, n);
+        if (!worthIt) {
+            candidate = active;
+            streak = 0;
+            return;
+        }  // if
+
+        streak = best == candidate ? streak + 1 : 1;
+        candidate = best;
+        if (streak >= kStreak || currentCost - bestCost > kUrgent * migrationCost(best, n)) {
+            migrateTo(best);
+        }  // if
+    }  // reconsider()
+};  // AdaptivePQ
+
+#endif  // ADAPTIVEPQ_H
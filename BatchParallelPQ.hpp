@@ -0,0 +1,268 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef BATCHPARALLELPQ_H
+#define BATCHPARALLELPQ_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+#include "Eecs281PQ.hpp"
+#include "LoserTree.hpp"
+
+// A priority queue for workloads that alternate large batches of inserts
+// with extractions of the best few, spreading each batch operation over
+// several threads.
+//
+// The elements are split between kPartitions BinaryPQs, each touched by
+// one thread at a time:
+// - insert_batch() cuts the batch into one slice per partition, and every
+//   partition takes its slice with one pushBatch() heapify, in parallel.
+// - extract_top_k() has every partition pop, in parallel, its share of k
+//   plus some slack, in order. The k most extreme elements are then merged
+//   from those runs with a LoserTree, popping more from a partition in the
+//   rare case its run is used up; what is left over goes back in parallel.
+//
+// The number of partitions is fixed, and the slices, shares and merge
+// don't depend on the thread count (ties go to the lower partition), so
+// neither does the output. COMP_FUNCTOR is called from several threads at
+// once and must not throw.
+//
+// The single-element Eecs281PQ operations work too; top() and pop() look
+// at every partition's top.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class BatchParallelPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Description: Construct an empty PQ with an optional comparison functor,
+    //              using up to 'threads' threads per batch operation.
+    // Runtime: O(1)
+    explicit BatchParallelPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                             std::size_t threads = std::thread::hardware_concurrency())
+        : BaseClass { comp }, partitions(kPartitions, BinaryPQ<TYPE, COMP_FUNCTOR> { comp }),
+          threads(threads == 0 ? 1 : threads) {}
+
+
+    // Description: Construct a PQ out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n / threads) where n is number of elements in range.
+    template<typename InputIterator>
+    BatchParallelPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                    std::size_t threads = std::thread::hardware_concurrency())
+        : BatchParallelPQ { comp, threads } {
+        insert_batch(start, end);
+    }  // BatchParallelPQ
+
+
+    // Description: Destructor doesn't need any code, the partitions will be
+    //              destroyed automatically.
+    virtual ~BatchParallelPQ() = default;
+
+
+    // Description: Copying and moving need no code either.
+    BatchParallelPQ(const BatchParallelPQ &) = default;
+    BatchParallelPQ(BatchParallelPQ &&) noexcept = default;
+    BatchParallelPQ &operator=(const BatchParallelPQ &) = default;
+    BatchParallelPQ &operator=(BatchParallelPQ &&) noexcept = default;
+
+
+    // Description: Add every element of [start, end).
+    // Runtime: O(k / threads) for k new elements, or O(k log(n) / threads)
+    //          if they are much fewer than the n already in the PQ
+    template<typename InputIterator>
+    void insert_batch(InputIterator start, InputIterator end) {
+        const std::vector<TYPE> batch(start, end);
+        const std::size_t n = batch.size();
+        // Rotate which partition gets the first slice, so that small
+        // batches don't all land in the same few partitions.
+        const std::size_t first = next;
+        forEachPartition(n, [&](std::size_t p) {
+            const std::size_t slice = (p + kPartitions - first) % kPartitions;
+            partitions[p].pushBatch(batch.begin() + static_cast<std::ptrdiff_t>(slice * n / kPartitions),
+                                    batch.begin() + static_cast<std::ptrdiff_t>((slice + 1) * n / kPartitions));
+        });
+        next = (first + n) % kPartitions;
+        count += n;
+    }  // insert_batch()
+
+
+    // Description: Remove the k most extreme elements (or all of them, if
+    //              there are fewer) and return them, most extreme first.
+    // Runtime: O(k log(n) / threads + k log(kPartitions))
+    std::vector<TYPE> extract_top_k(std::size_t k) {
+        k = std::min(k, count);
+        std::vector<TYPE> result;
+        result.reserve(k);
+        if (k == 0) return result;
+
+        // Each partition's share of k, plus a few standard deviations: with
+        // the elements spread evenly, running out is rare, and costs one
+        // sequential pop per extra element when it happens.
+        const std::size_t share = (k + kPartitions - 1) / kPartitions;
+        const std::size_t quota = share + 4 * static_cast<std::size_t>(std::sqrt(static_cast<double>(share))) + 8;
+        std::vector<std::vector<TYPE>> runs(kPartitions);
+        forEachPartition(quota * kPartitions, [&](std::size_t p) {
+            BinaryPQ<TYPE, COMP_FUNCTOR> &partition = partitions[p];
+            std::vector<TYPE> &run = runs[p];
+            while (run.size() < quota && !partition.empty()) {
+                run.push_back(partition.top());
+                partition.pop();
+            }  // while
+        });
+
+        LoserTree<TYPE, COMP_FUNCTOR> tree { kPartitions, this->compare };
+        std::vector<std::size_t> used(kPartitions, 0);
+        for (std::size_t p = 0; p < kPartitions; ++p) {
+            if (!runs[p].empty()) tree.prime(p, runs[p].front());
+        }  // for ..p
+        tree.build();
+
+        while (result.size() < k) {
+            const std::size_t p = tree.topSource();
+            result.push_back(tree.top());
+            if (++used[p] == runs[p].size() && !partitions[p].empty()) {
+                runs[p].push_back(partitions[p].top());
+                partitions[p].pop();
+            }  // if
+            if (used[p] < runs[p].size()) {
+                tree.replace_top(runs[p][used[p]]);
+            } else {
+                tree.exhaust_top();
+            }  // if
+        }  // while
+
+        forEachPartition(quota * kPartitions, [&](std::size_t p) {
+            partitions[p].pushBatch(runs[p].begin() + static_cast<std::ptrdiff_t>(used[p]), runs[p].end());
+        });
+        count -= k;
+        return result;
+    }  // extract_top_k()
+
+
+    // Description: Assumes that all elements inside the PQ are out of order
+    //              and rebuilds every partition.
+    // Runtime: O(n / threads)
+    virtual void updatePriorities() {
+        forEachPartition(count, [this](std::size_t p) { partitions[p].updatePriorities(); });
+    }  // updatePriorities()
+
+
+    // Description: Add a new element to the PQ.
+    // Runtime: O(log(n))
+    virtual void push(const TYPE &val) {
+        partitions[next].push(val);
+        next = (next + 1) % kPartitions;
+        ++count;
+    }  // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element
+    //              from the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: O(log(n) + kPartitions)
+    virtual void pop() {
+        partitions[bestPartition()].pop();
+        --count;
+    }  // pop()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: O(kPartitions)
+    virtual const TYPE &top() const { return partitions[bestPartition()].top(); }
+
+
+    // Description: Get the number of elements in the PQ.
+    // Runtime: O(1)
+    [[nodiscard]] virtual std::size_t size() const { return count; }
+
+
+    // Description: Return true if the PQ is empty.
+    // Runtime: O(1)
+    [[nodiscard]] virtual bool empty() const { return count == 0; }
+
+
+    // Description: Get or set the number of threads per batch operation.
+    // Runtime: O(1)
+    [[nodiscard]] std::size_t threadCount() const { return threads; }
+    void setThreadCount(std::size_t newThreads) { threads = newThreads == 0 ? 1 : newThreads; }
+
+private:
+    // Enough partitions to keep 32 cores busy. Fixed, so that the output
+    // doesn't depend on the thread count.
+    static const std::size_t kPartitions = 32;
+    // Work below this many elements per thread isn't worth a thread.
+    static const std::size_t kMinPerThread = 1 << 14;
+
+    std::vector<BinaryPQ<TYPE, COMP_FUNCTOR>> partitions;
+    std::size_t count = 0;
+    std::size_t next = 0;  // where push() and the next batch's first slice go
+    std::size_t threads;
+
+
+    // Description: Run body(p) for every partition p, spread over as many
+    //              threads as 'work' elements are worth, the calling thread
+    //              included. Each partition is touched by one thread. If
+    //              a thread can't be started, its partitions run on the
+    //              calling thread.
+    template<typename BODY>
+    void forEachPartition(std::size_t work, BODY body) const {
+        const std::size_t tasks = std::max<std::size_t>(1, std::min({ threads, kPartitions, work / kMinPerThread }));
+        auto run = [&body, tasks](std::size_t t) {
+            for (std::size_t p = t * kPartitions / tasks; p < (t + 1) * kPartitions / tasks; ++p) {
+                body(p);
+            }  // for ..p
+        };
+
+        std::vector<std::thread> helpers;
+        helpers.reserve(tasks - 1);
+        // Every helper started is joined however this returns: destroying
+        // a joinable std::thread calls std::terminate.
+        auto joinHelpers = [&helpers] {
+            for (std::thread &helper : helpers) {
+                helper.join();
+            }  // for ..helper
+        };
+        std::size_t started = 1;
+        try {
+            for (; started < tasks; ++started) {
+                helpers.emplace_back(run, started);
+            }  // for ..started
+        } catch (const std::system_error &) {
+            // Out of threads: the tasks that didn't get one run here.
+        }  // try
+        try {
+            for (std::size_t t = started; t < tasks; ++t) {
+                run(t);
+            }  // for ..t
+            run(0);
+        } catch (...) {
+            joinHelpers();
+            throw;
+        }  // try
+        joinHelpers();
+    }  // forEachPartition()
+
+
+    // Description: The non-empty partition with the most extreme top. Ties
+    //              go to the lower partition, as in extract_top_k().
+    std::size_t bestPartition() const {
+        std::size_t best = kPartitions;
+        for (std::size_t p = 0; p < kPartitions; ++p) {
+            if (partitions[p].empty()) continue;
+            if (best == kPartitions || this->compare(partitions[best].top(), partitions[p].top())) best = p;
+        }  // for ..p
+        return best;
+    }  // bestPartition()
+};  // BatchParallelPQ
+
+#endif  // BATCHPARALLELPQ_H
@@ -5,11 +5,37 @@
 
 
 #include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
 
 #include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+#include "PQSnapshot.hpp"
+
+// Whether BinaryPQ sifts TYPE down with its branch-free kernel: by default
+// for trivially copyable types of up to two words, which are cheap to hold
+// in a register and copy into a hole. Specialize it to force either path.
+template<typename TYPE>
+struct BinaryHeapFastSift
+    : std::integral_constant<bool, std::is_trivially_copyable<TYPE>::value
+                                   && sizeof(TYPE) <= 2 * sizeof(void *)> {};
+
 
 // A specialized version of the priority queue ADT implemented as a binary heap.
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+//
+// Elements can be cancelled in place with erase_if() or invalidate(): they
+// become tombstones, which top() and pop() never expose and size() doesn't
+// count. A dead root is discarded as soon as one surfaces, and once
+// tombstones make up more than the compaction fraction of the heap they are
+// all dropped and the heap rebuilt. Until the first tombstone is created
+// the heap carries no per-element bookkeeping at all.
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp). ALLOC
+// allocates the element vector; pmr::BinaryPQ (below) draws it from a
+// std::pmr::memory_resource.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument,
+         typename ALLOC = std::allocator<TYPE>>
 class BinaryPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
@@ -17,8 +43,8 @@ class BinaryPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
 public:
     // Description: Construct an empty PQ with an optional comparison functor.
     // Runtime: O(1)
-    explicit BinaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
-        : BaseClass { comp } {
+    explicit BinaryPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(), const ALLOC &alloc = ALLOC())
+        : BaseClass { comp }, data(alloc) {
         }  // BinaryPQ
 
 
@@ -26,8 +52,9 @@ public:
     //              comparison functor.
     // Runtime: O(n) where n is number of elements in range.
     template<typename InputIterator>
-    BinaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
-        : BaseClass { comp } {
+    BinaryPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+             const ALLOC &alloc = ALLOC())
+        : BaseClass { comp }, data(alloc) {
         // TODO: Implement this function
         data.assign(start, end);
         updatePriorities();
@@ -55,7 +82,9 @@ public:
     //              'rebuilds' the heap by fixing the heap invariant.
     // Runtime: O(n)
     virtual void updatePriorities() {
-        // TODO: Implement this function.
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+        dirty.clear();
+        removeTombstones();
         for (int i = (int(data.size()) - 1) / 2; i >= 0; --i) {
             fixDown(i);
         }
@@ -65,12 +94,42 @@ public:
     // Description: Add a new element to the PQ.
     // Runtime: O(log(n))
     virtual void push(const TYPE &val) {
-        // TODO: Implement this function.
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
         data.push_back(val);
+        if (!tombstones.empty()) tombstones.push_back(0);
         fixUp(data.size() - 1);
     }  // push()
 
 
+    // Description: Add every element of [start, end) at once. The new
+    //              elements are appended and only they and their ancestors
+    //              are heapified, level by level from the bottom up, which
+    //              is what updatePriorities() would do restricted to the
+    //              subtrees that changed.
+    // Runtime: O(k + log(n)^2) for k new elements
+    template<typename InputIterator>
+    void pushBatch(InputIterator start, InputIterator end) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        const std::size_t oldSize = data.size();
+        data.insert(data.end(), start, end);
+        if (data.size() == oldSize) return;
+        if (!tombstones.empty()) tombstones.resize(data.size(), 0);
+
+        // The slots to fix at each level form one contiguous range: the new
+        // slots first, then their parents, and so on up to the root.
+        std::size_t lo = oldSize;
+        std::size_t hi = data.size() - 1;
+        while (true) {
+            for (std::size_t i = hi + 1; i-- > lo; ) {
+                fixDown(i);
+            }  // for ..i
+            if (lo == 0) break;
+            lo = (lo - 1) / 2;
+            hi = (hi - 1) / 2;
+        }  // while
+    }  // pushBatch()
+
+
     // Description: Remove the most extreme (defined by 'compare') element
     //              from the PQ.
     // Note: We will not run tests on your code that would require it to pop
@@ -78,22 +137,48 @@ public:
     // familiar with them, you do not need to use exceptions in this project.
     // Runtime: O(log(n))
     virtual void pop() {
-        // TODO: Implement this function.
-        std::swap(data[0], data.back());
-        data.pop_back();
-        if (!data.empty()) fixDown(0);
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+        removeRoot();
+        discardDeadRoots();
     }  // pop()
 
 
+    // Description: Replace the most extreme element with val, equivalent to
+    //              pop() followed by push(val) but with a single sift.
+    // Note: The PQ must not be empty.
+    // Runtime: O(log(n))
+    void replace_top(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::ReplaceTop };
+        data.front() = val;
+        fixDown(0);
+        discardDeadRoots();
+    }  // replace_top()
+
+
+    // Description: Equivalent to push(val) followed by pop(), returning the
+    //              element that was removed. If val would be popped right
+    //              back out, the heap is not touched at all.
+    // Runtime: O(log(n))
+    TYPE pushpop(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::ReplaceTop };
+        if (data.empty() || !lowerPriority(val, data.front())) return val;
+
+        TYPE result = std::move(data.front());
+        data.front() = val;
+        fixDown(0);
+        discardDeadRoots();
+        return result;
+    }  // pushpop()
+
+
     // Description: Return the most extreme (defined by 'compare') element of
     //              the PQ. This should be a reference for speed. It MUST
     //              be const because we cannot allow it to be modified, as
     //              that might make it no longer be the most extreme element.
     // Runtime: O(1)
     virtual const TYPE &top() const {
-        // TODO: Implement this function.
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
         return data.front();
-        // These lines are present only so that this provided file compiles.
     }  // top()
 
 
@@ -102,11 +187,13 @@ public:
     [[nodiscard]] virtual std::size_t size() const {
         // TODO: Implement this function. Might be very simple,
         // depending on your implementation.
-        return data.size(); 
+        return data.size() - numDead;
     }  // size()
 
 
     // Description: Return true if the PQ is empty.
+    // Note: The root is never a tombstone, so the heap is empty exactly when
+    //       there are no live elements.
     // Runtime: O(1)
     [[nodiscard]] virtual bool empty() const {
         // TODO: Implement this function. Might be very simple,
@@ -115,43 +202,455 @@ public:
     }  // empty()
 
 
+    // Description: Pop every element for which pred(element) is true into
+    //              'out', most extreme first (see Eecs281PQ::drain_while()).
+    //              Below an element pred rejects everything is rejected, so
+    //              the accepted ones form a subtree at the root, found
+    //              without touching the rest. A few are popped one by one;
+    //              past n / log(n) they are taken out together, the heap is
+    //              rebuilt once, and they are sorted.
+    // Runtime: O(k log(n)) for k elements drained, and at most
+    //          O(n + k log(k))
+    template<typename PREDICATE, typename OutputIterator>
+    OutputIterator drain_while(PREDICATE pred, OutputIterator out) {
+        std::vector<std::size_t> taken;
+        if (!data.empty() && pred(data[0])) taken.push_back(0);
+        for (std::size_t next = 0; next < taken.size(); ++next) {
+            for (std::size_t child = 2 * taken[next] + 1; child <= 2 * taken[next] + 2 && child < data.size(); ++child) {
+                if (pred(data[child])) taken.push_back(child);
+            }  // for ..child
+        }  // for ..next
+
+        std::size_t depth = 0;
+        for (std::size_t rest = data.size(); rest > 1; rest /= 2) {
+            ++depth;
+        }  // for ..rest
+        if (taken.size() * depth < data.size()) {
+            while (!empty() && pred(top())) {
+                *out = top();
+                ++out;
+                pop();
+            }  // while
+            return out;
+        }  // if
+
+        std::vector<TYPE> drained;
+        drained.reserve(taken.size());
+        for (std::size_t i : taken) {
+            if (isDead(i)) continue;
+            drained.push_back(std::move(data[i]));
+            markDead(i);
+        }  // for ..i
+        updatePriorities();
+        std::sort(drained.begin(), drained.end(),
+                  [this](const TYPE &a, const TYPE &b) { return lowerPriority(b, a); });
+        return std::move(drained.begin(), drained.end(), out);
+    }  // drain_while()
+
+
+    // Description: Pop every element more extreme than 'threshold' into
+    //              'out', most extreme first.
+    // Runtime: As drain_while()
+    template<typename OutputIterator>
+    OutputIterator pop_above(const TYPE &threshold, OutputIterator out) {
+        return drain_while([this, &threshold](const TYPE &val) { return lowerPriority(threshold, val); }, out);
+    }  // pop_above()
+
+
+    // Description: Turn every live element for which pred(element) is true
+    //              into a tombstone. Returns how many were erased.
+    // Runtime: O(n), plus O(n) for a compaction or O(log(n)) per dead root
+    //          discarded
+    template<typename PREDICATE>
+    std::size_t erase_if(PREDICATE pred) {
+        std::size_t erased = 0;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (!isDead(i) && pred(data[i])) {
+                markDead(i);
+                ++erased;
+            }  // if
+        }  // for ..i
+        if (erased > 0) settleTombstones();
+        return erased;
+    }  // erase_if()
+
+
+    // Description: Turn one live element equal to val (by operator==) into a
+    //              tombstone. Returns false if there was none.
+    // Runtime: O(n) worst case; subtrees whose root is less extreme than val
+    //          are skipped
+    bool invalidate(const TYPE &val) {
+        std::vector<std::size_t> pending;
+        if (!data.empty()) pending.push_back(0);
+        while (!pending.empty()) {
+            const std::size_t i = pending.back();
+            pending.pop_back();
+            // Nothing below a less extreme element can be equal to val.
+            if (lowerPriority(data[i], val)) continue;
+            if (!isDead(i) && data[i] == val) {
+                markDead(i);
+                settleTombstones();
+                return true;
+            }  // if
+            for (std::size_t child = 2 * i + 1; child <= 2 * i + 2 && child < data.size(); ++child) {
+                pending.push_back(child);
+            }  // for ..child
+        }  // while
+        return false;
+    }  // invalidate()
+
+
+    // Description: Set the fraction of the heap that tombstones may occupy
+    //              before they are all dropped and the heap rebuilt
+    //              (default 0.5).
+    // Runtime: O(1)
+    void setCompactionFraction(double fraction) { compactionFraction = fraction; }
+
+
+    // Description: Record that every element equal to val (by operator==)
+    //              may have changed priority, for the next updateDirty().
+    //              Returns how many elements were marked.
+    // Runtime: O(n), but without any comparisons
+    std::size_t markDirty(const TYPE &val) {
+        return markDirtyIf([&val](const TYPE &elt) { return elt == val; });
+    }  // markDirty()
+
+
+    // Description: Record that every element for which pred(element) is true
+    //              may have changed priority. Returns how many were marked.
+    // Runtime: O(n)
+    template<typename PREDICATE>
+    std::size_t markDirtyIf(PREDICATE pred) {
+        std::size_t marked = 0;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (pred(data[i])) {
+                dirty.push_back(i);
+                ++marked;
+            }  // if
+        }  // for ..i
+        return marked;
+    }  // markDirtyIf()
+
+
+    // Description: Restore the heap after changing only the elements marked
+    //              dirty, like updatePriorities() but touching just the
+    //              dirty slots and their ancestors. Falls back to a full
+    //              rebuild when that would be no cheaper.
+    // Note: Nothing else may be done to the PQ between marking and calling
+    //       updateDirty(), as a push or pop would move the marked slots.
+    // Runtime: O(k log^2(n)) worst case for k dirty elements, O(n) at most
+    void updateDirty() {
+        if (dirty.empty()) return;
+
+        // Heapify restricted to the subtrees that contain a dirty slot: the
+        // dirty slots and all their ancestors, fixed bottom-up. Every other
+        // subtree is still a heap, so this restores the invariant.
+        std::vector<std::size_t> slots;
+        for (std::size_t i : dirty) {
+            for (;; i = (i - 1) / 2) {
+                slots.push_back(i);
+                if (i == 0) break;
+            }  // for ..i
+        }  // for ..i
+        dirty.clear();
+        std::sort(slots.begin(), slots.end(), std::greater<std::size_t>());
+        slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+
+        // A full heapify visits half the slots.
+        if (slots.size() >= data.size() / 2) {
+            updatePriorities();
+            return;
+        }  // if
+
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+        for (std::size_t i : slots) {
+            fixDown(i);
+        }  // for ..i
+        discardDeadRoots();
+    }  // updateDirty()
+
+
+    // Description: Write the PQ's live contents to a snapshot file at 'path'
+    //              (see PQSnapshot.hpp). TYPE must be trivially copyable.
+    // Throws: std::runtime_error if the file can't be written.
+    // Runtime: O(n)
+    void save(const std::string &path) const {
+        if (numDead == 0) {
+            writeSnapshot(path, SnapshotKind::Heap, data.data(), data.size());
+            return;
+        }  // if
+
+        // Without its tombstones the array is no longer a heap.
+        std::vector<TYPE> live;
+        live.reserve(size());
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (tombstones[i] == 0) live.push_back(data[i]);
+        }  // for ..i
+        writeSnapshot(path, SnapshotKind::Unordered, live.data(), live.size());
+    }  // save()
+
+
+    // Description: Replace the PQ's contents with a snapshot written by
+    //              save(). A heap snapshot is used as is;
+    //              any other array snapshot is re-heapified.
+    //              The snapshot must have been saved with the same COMP_FUNCTOR.
+    // Throws: std::runtime_error if the snapshot is unreadable or corrupt;
+    //         the PQ is then left empty.
+    // Runtime: O(n)
+    void load(const std::string &path) {
+        dirty.clear();
+        tombstones.clear();
+        numDead = 0;
+        if (readArraySnapshot(path, data) != SnapshotKind::Heap) {
+            updatePriorities();
+        }  // if
+    }  // load()
+
+
+    // Description: Move the live elements out, in heap order, leaving the
+    //              PQ empty. Used to hand the vector to another PQ without
+    //              copying it.
+    // Runtime: O(1), or O(n) if there are tombstones to drop
+    std::vector<TYPE, ALLOC> releaseData() {
+        dirty.clear();
+        removeTombstones();
+        std::vector<TYPE, ALLOC> result = std::move(data);
+        data.clear();
+        return result;
+    }  // releaseData()
+
+
+    // Description: Replace the PQ's contents with 'elements', taking over
+    //              the vector rather than copying it. 'arrangement' says how
+    //              they are already ordered (as in a snapshot); a heap is
+    //              used as is, anything else is re-heapified. A vector
+    //              sorted most extreme first is a heap too.
+    // Runtime: O(1) for a heap, else O(n)
+    void adoptData(std::vector<TYPE, ALLOC> &&elements, SnapshotKind arrangement = SnapshotKind::Unordered) {
+        dirty.clear();
+        tombstones.clear();
+        numDead = 0;
+        data = std::move(elements);
+        if (arrangement != SnapshotKind::Heap) {
+            updatePriorities();
+        }  // if
+    }  // adoptData()
+
+
+    // Description: Access the instrumentation policy, e.g. to dump() or
+    //              reset() a CountingInstrument.
+    // Runtime: O(1)
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+
+    // Description: Return a copy of the allocator of the element vector.
+    // Runtime: O(1)
+    ALLOC get_allocator() const { return data.get_allocator(); }
+
+
 private:
     // Note: This vector *must* be used for your PQ implementation.
-    std::vector<TYPE> data;
-    // NOTE: You are not allowed to add any member variables. You don't need
-    //       a "heapSize", since you can call your own size() member
-    //       function, or check data.size().
-
-    // TODO: Add any additional member functions you require here.
-    //       For instance, you might add fixUp() and fixDown().
+    std::vector<TYPE, ALLOC> data;
+    // NOTE: You don't need a "heapSize", since you can call your own size()
+    //       member function, or check data.size().
+
+    // tombstones[i] is set if data[i] has been erased. Empty while there
+    // are no tombstones, so the sifts don't pay for it until then.
+    std::vector<unsigned char> tombstones;
+    std::size_t numDead = 0;
+    double compactionFraction = 0.5;
+
+    // Slots marked by markDirty()/markDirtyIf() since the last repair.
+    std::vector<std::size_t> dirty;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // Description: this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }  // lowerPriority()
+
+    bool isDead(std::size_t i) const { return !tombstones.empty() && tombstones[i] != 0; }
+
+    void markDead(std::size_t i) {
+        if (tombstones.empty()) tombstones.assign(data.size(), 0);
+        tombstones[i] = 1;
+        ++numDead;
+    }  // markDead()
+
+    // Description: Swap two slots, carrying their tombstone marks along.
+    void swapSlots(std::size_t a, std::size_t b) {
+        std::swap(data[a], data[b]);
+        if (!tombstones.empty()) std::swap(tombstones[a], tombstones[b]);
+        instrument.countMoves(1);
+    }  // swapSlots()
+
+    // Description: Remove data[0], live or dead, and restore the heap.
+    void removeRoot() {
+        swapSlots(0, data.size() - 1);
+        data.pop_back();
+        if (!tombstones.empty()) tombstones.pop_back();
+        if (!data.empty()) fixDown(0);
+    }  // removeRoot()
+
+    // Description: Pop tombstones off the root until a live element is
+    //              there (or the heap is empty).
+    void discardDeadRoots() {
+        while (numDead > 0 && !data.empty() && tombstones[0] != 0) {
+            --numDead;
+            removeRoot();
+        }  // while
+        if (numDead == 0) tombstones.clear();
+    }  // discardDeadRoots()
+
+    // Description: After new tombstones, compact if there are too many,
+    //              otherwise just make sure the root is live.
+    void settleTombstones() {
+        if (static_cast<double>(numDead) > compactionFraction * static_cast<double>(data.size())) {
+            updatePriorities();
+        } else {
+            discardDeadRoots();
+        }  // if
+    }  // settleTombstones()
+
+    // Description: Drop every tombstone from data, leaving it unordered.
+    void removeTombstones() {
+        if (numDead > 0) {
+            std::size_t out = 0;
+            for (std::size_t i = 0; i < data.size(); ++i) {
+                if (tombstones[i] != 0) continue;
+                if (out != i) data[out] = std::move(data[i]);
+                ++out;
+            }  // for ..i
+            data.resize(out);
+            numDead = 0;
+        }  // if
+        tombstones.clear();
+    }  // removeTombstones()
 
     void fixUp(std::size_t i) {
         while (i > 0) {
             std::size_t parent = (i - 1) / 2;
-            if (!this->compare(data[parent], data[i])) break;
-            std::swap(data[parent], data[i]);
+            if (!lowerPriority(data[parent], data[i])) break;
+            swapSlots(parent, i);
             i = parent;
         }
     }
 
     void fixDown(std::size_t i) {
+        if constexpr (BinaryHeapFastSift<TYPE>::value) {
+            // Tombstone marks have to travel with their elements, which
+            // only the swapping loop below does.
+            if (tombstones.empty() && data.size() <= kFastSiftMaxSize) {
+                fixDownHole(i);
+                return;
+            }  // if
+        }  // if
+
         std::size_t size = data.size();
         while (2 * i + 1 < size) {
             std::size_t left = 2 * i + 1;
             std::size_t right = 2 * i + 2;
             std::size_t extreme = left;
 
-            if (right < size && this->compare(data[left], data[right])) {
+            if (right < size && lowerPriority(data[left], data[right])) {
                 extreme = right;
             }
 
-            if (!this->compare(data[i], data[extreme])) break;
-            std::swap(data[i], data[extreme]);
+            if (!lowerPriority(data[i], data[extreme])) break;
+            swapSlots(i, extreme);
             i = extreme;
         }
     }
 
+    // Description: fixDown for small trivially copyable TYPEs (Floyd's
+    //              bottom-up sift). The hole left by data[i] first walks all
+    //              the way down, always into the more extreme child, picked
+    //              with a conditional move rather than a branch; then the
+    //              displaced element climbs back up from the bottom, which
+    //              for random keys is rarely more than a level or two. That
+    //              takes one comparison per level instead of two and has no
+    //              early exit to mispredict. While the children are
+    //              compared, their descendants kPrefetchLevels levels down
+    //              are prefetched (for ints, the 16 slots three levels
+    //              below), so the hole finds them in cache when it gets
+    //              there.
+    void fixDownHole(std::size_t i) {
+        TYPE *heap = data.data();
+        const std::size_t size = data.size();
+        // A leaf has nowhere to go; updatePriorities() on an empty heap
+        // even passes i = 0 with no slot 0 at all.
+        if (2 * i + 1 >= size) return;
+        const std::size_t start = i;
+        const TYPE val = heap[i];
+
+        std::size_t child = 2 * i + 1;
+        while (child + 1 < size) {
+            prefetchDescendants(heap, child, size);
+            child += static_cast<std::size_t>(lowerPriority(heap[child], heap[child + 1]));
+            heap[i] = heap[child];
+            instrument.countMoves(1);
+            i = child;
+            child = 2 * i + 1;
+        }  // while
+        if (child < size) {  // a lone left child on the last level
+            heap[i] = heap[child];
+            instrument.countMoves(1);
+            i = child;
+        }  // if
+
+        while (i > start) {
+            const std::size_t parent = (i - 1) / 2;
+            if (!lowerPriority(heap[parent], val)) break;
+            heap[i] = heap[parent];
+            instrument.countMoves(1);
+            i = parent;
+        }  // while
+        heap[i] = val;
+    }  // fixDownHole()
+
+    // Past this many elements (64MB) most levels of a sift miss the cache,
+    // and the branchy loop wins after all: the CPU speculates down its
+    // predicted child and overlaps the misses of several levels, where the
+    // conditional move has to wait for each comparison. Measured crossover
+    // for ints was between 10 and 30 million.
+    static constexpr std::size_t kFastSiftMaxSize = (std::size_t { 64 } << 20) / sizeof(TYPE);
+
+    // Levels below the current pair of children to prefetch: as deep as
+    // their descendants there still fit in a cache line (16 ints, so three
+    // levels ahead), which overlaps that many levels of cache misses.
+    static constexpr std::size_t kPrefetchLevels = sizeof(TYPE) <= 4 ? 3 : sizeof(TYPE) <= 8 ? 2 : 1;
+
+    // Description: Prefetch the descendants of heap[child] and
+    //              heap[child + 1] kPrefetchLevels levels down, which are
+    //              contiguous.
+    static void prefetchDescendants([[maybe_unused]] const TYPE *heap, [[maybe_unused]] std::size_t child,
+                                    [[maybe_unused]] std::size_t size) {
+#if defined(__GNUC__)
+        std::size_t first = child;
+        for (std::size_t level = 0; level < kPrefetchLevels; ++level) {
+            first = 2 * first + 1;
+        }  // for ..level
+        const std::size_t last = first + (std::size_t { 2 } << kPrefetchLevels) - 1;
+        if (first < size) __builtin_prefetch(heap + first);
+        if (last < size) __builtin_prefetch(heap + last);
+#endif
+    }  // prefetchDescendants()
+
 };  // BinaryPQ
 
 
+
+namespace pmr {
+
+// BinaryPQ whose elements live in a std::pmr::memory_resource, passed after
+// the comparator: pmr::BinaryPQ<int> pq { std::less<int>(), &arena };
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+using BinaryPQ = ::BinaryPQ<TYPE, COMP_FUNCTOR, INSTRUMENT, std::pmr::polymorphic_allocator<TYPE>>;
+
+}  // namespace pmr
+
 #endif  // BINARYPQ_H
@@ -0,0 +1,277 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef COMPACTPAIRINGPQ_H
+#define COMPACTPAIRINGPQ_H
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+
+// A pairing heap whose nodes live contiguously in one std::vector and link
+// to each other with 32-bit indices instead of pointers.
+//
+// Each node holds the element and three links (child, sibling, prev); there
+// is no parent link, because the leftmost child's prev points to its parent
+// instead. For ints that is 16 bytes per element against 40 for PairingPQ,
+// and nodes that were pushed together stay close together in memory.
+//
+// addNode() returns an integer Handle for updateElt() and getElt(). A handle
+// stays valid until its element is popped; after that its slot goes on a
+// free list and may be handed out again by a later addNode(). Copying the PQ
+// copies the vector, and handles refer to the same elements in the copy.
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp).
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+class CompactPairingPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    using Handle = std::uint32_t;
+
+    // One slot of the node vector; public so callers can size it.
+    struct Node {
+        explicit Node(const TYPE &val)
+          : elt(val), child(kNone), sibling(kNone), prev(kNone) {}
+
+        TYPE elt;
+
+        // Leftmost child.
+        Handle child;
+
+        // Next sibling; for a freed node, the next node on the free list.
+        Handle sibling;
+
+        // Previous sibling, or the parent for a leftmost child; kNone for
+        // the root, kFreed for a node on the free list.
+        Handle prev;
+    };
+
+    // ============================
+    // Constructors
+    // ============================
+    explicit CompactPairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, root(kNone), freeList(kNone), numNodes(0) {}
+
+    template<typename InputIterator>
+    CompactPairingPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, root(kNone), freeList(kNone), numNodes(0) {
+        for (; start != end; ++start) {
+            push(*start);
+        }
+    }
+
+    // The nodes vector holds everything, so the defaults copy and move it.
+    CompactPairingPQ(const CompactPairingPQ &) = default;
+    CompactPairingPQ(CompactPairingPQ &&) noexcept = default;
+    CompactPairingPQ &operator=(const CompactPairingPQ &) = default;
+    CompactPairingPQ &operator=(CompactPairingPQ &&) noexcept = default;
+    virtual ~CompactPairingPQ() = default;
+
+    // ============================
+    // Required interface
+    // ============================
+    virtual void push(const TYPE &val) {
+        addNode(val);
+    }
+
+    virtual void pop() {
+        if (root == kNone) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+
+        const Handle oldRoot = root;
+        root = pairList(nodes[oldRoot].child);
+        release(oldRoot);
+    }
+
+    virtual const TYPE &top() const {
+        if (root == kNone) {
+            throw std::runtime_error("CompactPairingPQ: top() called on empty PQ!");
+        }
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
+        return nodes[root].elt;
+    }
+
+    [[nodiscard]] virtual std::size_t size() const { return numNodes; }
+    [[nodiscard]] virtual bool empty() const { return (root == kNone); }
+
+    // Rebuild the entire PQ after changes: unlink every live node and pair
+    // them all up again.
+    virtual void updatePriorities() {
+        if (root == kNone) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+
+        Handle list = kNone;
+        for (Handle i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].prev == kFreed) continue;
+            nodes[i].child = kNone;
+            nodes[i].prev = kNone;
+            nodes[i].sibling = list;
+            list = i;
+        }
+        root = pairList(list);
+    }
+
+    // ============================
+    // Pairing-heap-specific interface
+    // ============================
+
+    // Make the element at 'handle' more extreme. As in PairingPQ, a
+    // new_value that is not more extreme than the current one is ignored.
+    void updateElt(Handle handle, const TYPE &new_value) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdateElt };
+
+        if (!lowerPriority(nodes[handle].elt, new_value)) return;
+        nodes[handle].elt = new_value;
+
+        if (handle != root) {
+            cut(handle);
+            root = meld(root, handle);
+        }
+    }
+
+    // Add val and return its handle, for use with updateElt and getElt.
+    // Throws: std::length_error if 32-bit handles have run out.
+    Handle addNode(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+
+        Handle handle = freeList;
+        if (handle != kNone) {
+            freeList = nodes[handle].sibling;
+            nodes[handle] = Node(val);
+        } else {
+            if (nodes.size() >= kFreed) {
+                throw std::length_error("CompactPairingPQ: out of 32-bit handles");
+            }
+            handle = static_cast<Handle>(nodes.size());
+            nodes.emplace_back(val);
+            instrument.countAllocation();
+        }
+
+        root = meld(root, handle);
+        ++numNodes;
+        return handle;
+    }
+
+    // The element at 'handle', which must not have been popped.
+    const TYPE &getElt(Handle handle) const { return nodes[handle].elt; }
+
+    // Reserve node storage for 'count' elements, so addNode doesn't
+    // reallocate the vector on the way there.
+    void reserve(std::size_t count) { nodes.reserve(count); }
+
+    // Access the instrumentation policy, e.g. to dump() or reset() a
+    // CountingInstrument.
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+private:
+    // No node; an empty link.
+    static constexpr Handle kNone = std::numeric_limits<Handle>::max();
+    // Marks a node on the free list (in its prev link).
+    static constexpr Handle kFreed = kNone - 1;
+
+    std::vector<Node> nodes;
+    Handle root;            // The root of the pairing heap, or kNone
+    Handle freeList;        // Head of the list of freed nodes, or kNone
+    std::size_t numNodes;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // ============================
+    // Private helper functions
+    // ============================
+
+    // this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }
+
+    // Meld two trees, returning the resulting root. Both roots must have
+    // no siblings.
+    Handle meld(Handle first, Handle second) {
+        if (first == kNone) return second;
+        if (second == kNone) return first;
+
+        if (lowerPriority(nodes[first].elt, nodes[second].elt)) {
+            std::swap(first, second);
+        }
+        instrument.countMoves(1);
+
+        // Attach 'second' as the leftmost child of 'first'.
+        Node &top = nodes[first];
+        Node &sub = nodes[second];
+        sub.sibling = top.child;
+        sub.prev = first;
+        if (top.child != kNone) nodes[top.child].prev = second;
+        top.child = second;
+        return first;
+    }
+
+    // Detach 'handle' and its subtree from its parent or left sibling.
+    // 'handle' must not be the root.
+    void cut(Handle handle) {
+        Node &node = nodes[handle];
+        Node &prev = nodes[node.prev];
+        if (prev.child == handle) {
+            prev.child = node.sibling;
+        } else {
+            prev.sibling = node.sibling;
+        }
+        if (node.sibling != kNone) nodes[node.sibling].prev = node.prev;
+        node.sibling = kNone;
+        node.prev = kNone;
+    }
+
+    // Two-pass pairing of a sibling list starting at 'list': meld
+    // neighbours left to right, then meld the pairs right to left. The pairs
+    // are kept on a list threaded through their own sibling links.
+    Handle pairList(Handle list) {
+        std::size_t count = 0;
+        Handle pairs = kNone;  // Pairs, most recent first
+        while (list != kNone) {
+            const Handle first = list;
+            const Handle second = nodes[first].sibling;
+            list = second != kNone ? nodes[second].sibling : kNone;
+            detach(first);
+            if (second != kNone) detach(second);
+
+            const Handle pair = meld(first, second);
+            nodes[pair].sibling = pairs;
+            pairs = pair;
+            count += second != kNone ? 2 : 1;
+        }
+        instrument.recordRootChildren(count);
+
+        Handle result = kNone;
+        while (pairs != kNone) {
+            const Handle pair = pairs;
+            pairs = nodes[pair].sibling;
+            nodes[pair].sibling = kNone;
+            result = meld(pair, result);
+        }
+        return result;
+    }
+
+    // Clear a node's sibling links so it can be melded as a root.
+    void detach(Handle handle) {
+        nodes[handle].sibling = kNone;
+        nodes[handle].prev = kNone;
+    }
+
+    // Put a popped node on the free list.
+    void release(Handle handle) {
+        nodes[handle].child = kNone;
+        nodes[handle].prev = kFreed;
+        nodes[handle].sibling = freeList;
+        freeList = handle;
+        --numNodes;
+    }
+};
+
+#endif  // COMPACTPAIRINGPQ_H
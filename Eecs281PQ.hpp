@@ -44,6 +44,32 @@ public:
     //              implement this appropriately.
     virtual void updatePriorities() = 0;
 
+    // Description: Pop every element for which pred(element) is true,
+    //              writing them to 'out' most extreme first, and return the
+    //              iterator past the last one written. pred must accept a
+    //              prefix of the priority order, as a cutoff does: draining
+    //              stops at the first element it rejects. This version pops
+    //              one at a time; SortedPQ, BinaryPQ and PairingPQ hide it
+    //              with native ones.
+    // Runtime: O(k) calls of top() and pop() for k elements drained
+    template<typename PREDICATE, typename OutputIterator>
+    OutputIterator drain_while(PREDICATE pred, OutputIterator out) {
+        while (!empty() && pred(top())) {
+            *out = top();
+            ++out;
+            pop();
+        }  // while
+        return out;
+    }  // drain_while()
+
+    // Description: Pop every element more extreme than 'threshold' into
+    //              'out', most extreme first.
+    // Runtime: As drain_while()
+    template<typename OutputIterator>
+    OutputIterator pop_above(const TYPE &threshold, OutputIterator out) {
+        return drain_while([this, &threshold](const TYPE &val) { return compare(threshold, val); }, out);
+    }  // pop_above()
+
 protected:
     // Description: Compiler default implementation of constructors
     Eecs281PQ() = default;
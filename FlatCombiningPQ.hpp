@@ -0,0 +1,279 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef FLATCOMBININGPQ_H
+#define FLATCOMBININGPQ_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+
+// Thread-safe wrappers around the single-threaded PQs. Both take the element
+// type, comparator and engine (BinaryPQ, PairingPQ, ...) as template
+// arguments and offer the same small interface: push(val), tryPop(out) and
+// an approximate size().
+//
+// LockedPQ is the baseline: one mutex around the engine, so every thread
+// runs its own sift while holding the lock and pulls the heap into its own
+// cache to do it.
+//
+// FlatCombiningPQ publishes each request in a per-thread slot instead.
+// Whichever thread gets the combiner lock applies every pending request in
+// one pass, pushes first as a single batch (pushBatch() when the engine has
+// one), then the pops, while the other threads spin on their own slot. The
+// heap stays in the combiner's cache, and only the slots move between
+// cores.
+
+
+// Spin briefly, then start yielding, so waiting threads don't starve the
+// combiner when there are more threads than cores.
+class SpinBackoff {
+public:
+    void pause() {
+        if (++spins > kSpinLimit) std::this_thread::yield();
+    }  // pause()
+
+private:
+    static const unsigned kSpinLimit = 64;
+    unsigned spins = 0;
+};  // SpinBackoff
+
+
+// Description: Whether PQ has pushBatch(first, last) for an iterator type.
+template<typename PQ, typename ITERATOR, typename = void>
+struct HasPushBatch : std::false_type {};
+
+template<typename PQ, typename ITERATOR>
+struct HasPushBatch<PQ, ITERATOR, std::void_t<decltype(
+    std::declval<PQ &>().pushBatch(std::declval<ITERATOR>(), std::declval<ITERATOR>()))>>
+    : std::true_type {};
+
+
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+         template<typename...> typename PQ = BinaryPQ>
+class LockedPQ {
+public:
+    explicit LockedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR()) : pq { comp } {}
+
+    // Description: Add val to the PQ.
+    void push(const TYPE &val) {
+        std::lock_guard<std::mutex> lock { mutex };
+        pq.push(val);
+        count.store(pq.size(), std::memory_order_relaxed);
+    }  // push()
+
+
+    // Description: Remove the most extreme element into 'out'. Returns false,
+    //              leaving 'out' alone, if the PQ was empty.
+    bool tryPop(TYPE &out) {
+        std::lock_guard<std::mutex> lock { mutex };
+        if (pq.empty()) return false;
+        out = pq.top();
+        pq.pop();
+        count.store(pq.size(), std::memory_order_relaxed);
+        return true;
+    }  // tryPop()
+
+
+    // Description: The size as of some recent operation.
+    [[nodiscard]] std::size_t size() const { return count.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool empty() const { return size() == 0; }
+
+private:
+    std::mutex mutex;
+    PQ<TYPE, COMP_FUNCTOR> pq;
+    std::atomic<std::size_t> count { 0 };
+};  // LockedPQ
+
+
+// TYPE must be default constructible and copy assignable, as every slot
+// holds one.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>,
+         template<typename...> typename PQ = BinaryPQ>
+class FlatCombiningPQ {
+public:
+    // Description: Construct an empty PQ with 'slots' request slots. Each
+    //              thread starts looking for a free slot at its own index,
+    //              so with at least as many slots as threads they never
+    //              compete for one.
+    explicit FlatCombiningPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(), std::size_t slots = 64)
+        : pq { comp }, slots(slots == 0 ? 1 : slots) {}
+
+
+    FlatCombiningPQ(const FlatCombiningPQ &) = delete;
+    FlatCombiningPQ &operator=(const FlatCombiningPQ &) = delete;
+
+
+    // Description: Add val to the PQ.
+    void push(const TYPE &val) {
+        Slot &slot = claimSlot();
+        slot.op = Op::Push;
+        slot.value = val;
+        await(slot);
+        slot.state.store(Free, std::memory_order_release);
+    }  // push()
+
+
+    // Description: Remove the most extreme element into 'out'. Returns false,
+    //              leaving 'out' alone, if the PQ was empty.
+    bool tryPop(TYPE &out) {
+        Slot &slot = claimSlot();
+        slot.op = Op::Pop;
+        await(slot);
+        const bool ok = slot.ok;
+        if (ok) out = std::move(slot.value);
+        slot.state.store(Free, std::memory_order_release);
+        return ok;
+    }  // tryPop()
+
+
+    // Description: The size as of the last combining pass.
+    [[nodiscard]] std::size_t size() const { return count.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool empty() const { return size() == 0; }
+
+
+    // Description: How many combining passes applied at least one request,
+    //              and how many requests they applied in total; their ratio
+    //              is the average batch size.
+    [[nodiscard]] std::uint64_t batchCount() const { return batches.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t combinedCount() const {
+        return combined.load(std::memory_order_relaxed);
+    }  // combinedCount()
+
+private:
+    enum class Op : unsigned char { Push, Pop };
+
+    // Slot states: Free -> Claimed (owner writing the request) -> Pending
+    // (visible to the combiner) -> Done (result written) -> Free.
+    enum State : int { Free, Claimed, Pending, Done };
+
+    struct alignas(64) Slot {
+        std::atomic<int> state { Free };
+        Op op = Op::Push;
+        bool ok = false;
+        TYPE value {};
+    };  // Slot
+
+    // Combining passes over the slots per turn as combiner; later passes
+    // pick up requests published while the earlier ones ran.
+    static const int kCombinePasses = 3;
+
+    PQ<TYPE, COMP_FUNCTOR> pq;
+    std::vector<Slot> slots;
+    std::atomic<std::size_t> slotsUsed { 0 };  // combiners scan only these
+    std::atomic<bool> combining { false };
+    std::atomic<std::size_t> count { 0 };
+    std::atomic<std::uint64_t> batches { 0 };
+    std::atomic<std::uint64_t> combined { 0 };
+
+    // Scratch space, only touched by the combiner.
+    std::vector<TYPE> pushes;
+    std::vector<Slot *> applied;
+
+
+    // Description: A small number per thread, used to spread threads over
+    //              the slots.
+    static std::size_t threadIndex() {
+        static std::atomic<std::size_t> nextIndex { 0 };
+        static thread_local const std::size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }  // threadIndex()
+
+
+    // Description: Find a free slot, starting at this thread's own, and
+    //              claim it for a request.
+    Slot &claimSlot() {
+        SpinBackoff backoff;
+        for (std::size_t i = threadIndex() % slots.size(); ; i = (i + 1) % slots.size()) {
+            int expected = Free;
+            if (slots[i].state.compare_exchange_strong(expected, Claimed, std::memory_order_acquire)) {
+                std::size_t used = slotsUsed.load(std::memory_order_relaxed);
+                while (used <= i && !slotsUsed.compare_exchange_weak(used, i + 1)) {}
+                return slots[i];
+            }  // if
+            backoff.pause();
+        }  // for ..i
+    }  // claimSlot()
+
+
+    // Description: Publish the request in 'slot', then wait for a combiner
+    //              to apply it, becoming the combiner whenever the lock is
+    //              free.
+    void await(Slot &slot) {
+        slot.state.store(Pending, std::memory_order_release);
+        SpinBackoff backoff;
+        while (slot.state.load(std::memory_order_acquire) != Done) {
+            if (!combining.load(std::memory_order_relaxed)
+                && !combining.exchange(true, std::memory_order_acquire)) {
+                for (int pass = 0; pass < kCombinePasses && combine(); ++pass) {}
+                combining.store(false, std::memory_order_release);
+            } else {
+                backoff.pause();
+            }  // if
+        }  // while
+    }  // await()
+
+
+    // Description: Apply every pending request: all pushes as one batch,
+    //              then the pops. Returns false if there were none.
+    bool combine() {
+        pushes.clear();
+        applied.clear();
+        bool popsPending = false;
+        const std::size_t used = slotsUsed.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < used; ++i) {
+            Slot &slot = slots[i];
+            if (slot.state.load(std::memory_order_acquire) != Pending) continue;
+            if (slot.op == Op::Push) {
+                pushes.push_back(slot.value);
+                applied.push_back(&slot);
+            } else {
+                popsPending = true;
+            }  // if
+        }  // for ..slot
+        if (applied.empty() && !popsPending) return false;
+
+        pushAll();
+        for (Slot *slot : applied) {
+            slot->state.store(Done, std::memory_order_release);
+        }  // for ..slot
+
+        std::size_t pops = 0;
+        for (std::size_t i = 0; i < used && popsPending; ++i) {
+            Slot &slot = slots[i];
+            if (slot.state.load(std::memory_order_acquire) != Pending || slot.op != Op::Pop) continue;
+            slot.ok = !pq.empty();
+            if (slot.ok) {
+                slot.value = pq.top();
+                pq.pop();
+            }  // if
+            slot.state.store(Done, std::memory_order_release);
+            ++pops;
+        }  // for ..slot
+
+        count.store(pq.size(), std::memory_order_relaxed);
+        batches.fetch_add(1, std::memory_order_relaxed);
+        combined.fetch_add(applied.size() + pops, std::memory_order_relaxed);
+        return true;
+    }  // combine()
+
+
+    void pushAll() {
+        if constexpr (HasPushBatch<PQ<TYPE, COMP_FUNCTOR>,
+                                   typename std::vector<TYPE>::iterator>::value) {
+            pq.pushBatch(pushes.begin(), pushes.end());
+        } else {
+            for (const TYPE &val : pushes) {
+                pq.push(val);
+            }  // for ..val
+        }  // if
+    }  // pushAll()
+};  // FlatCombiningPQ
+
+#endif  // FLATCOMBININGPQ_H
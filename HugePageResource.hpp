@@ -0,0 +1,127 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef HUGEPAGERESOURCE_H
+#define HUGEPAGERESOURCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// A std::pmr::memory_resource that backs large blocks with huge pages, for
+// the pmr:: queues (pmr::BinaryPQ<int> pq { std::less<int>(), &huge };).
+// A big heap's sift paths touch a new 4 KB page on nearly every level, so
+// past a few MB each sift costs a dTLB miss per level; with 2 MB pages one
+// TLB entry covers 512 times as much of the array.
+//
+// Blocks of at least kHugePageSize bytes are mapped directly, rounded up to
+// whole huge pages:
+// - first with MAP_HUGETLB, which only succeeds if huge pages have been
+//   reserved (/proc/sys/vm/nr_hugepages);
+// - otherwise as ordinary memory aligned to kHugePageSize and marked with
+//   madvise(MADV_HUGEPAGE), so transparent huge pages back it when the
+//   kernel allows them ("madvise" or "always" in
+//   /sys/kernel/mm/transparent_hugepage/enabled).
+// Smaller blocks, and every block off Linux, come from the upstream
+// resource.
+class HugePageResource : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t kHugePageSize = std::size_t { 2 } << 20;
+
+
+    // Description: Construct a resource that passes small blocks on to
+    //              'upstream'.
+    // Runtime: O(1)
+    explicit HugePageResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : upstream { upstream } {}
+
+
+    HugePageResource(const HugePageResource &) = delete;
+    HugePageResource &operator=(const HugePageResource &) = delete;
+
+
+    // Description: Return the resource that serves small blocks.
+    std::pmr::memory_resource *upstream_resource() const { return upstream; }
+
+
+    // Description: How many blocks have been mapped with reserved huge
+    //              pages (MAP_HUGETLB), and how many with transparent ones
+    //              advised.
+    [[nodiscard]] std::size_t hugeTlbBlocks() const { return hugeTlb.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::size_t transparentBlocks() const { return transparent.load(std::memory_order_relaxed); }
+
+private:
+    std::pmr::memory_resource *upstream;
+    std::atomic<std::size_t> hugeTlb { 0 };
+    std::atomic<std::size_t> transparent { 0 };
+
+
+    static bool mapped(std::size_t bytes, std::size_t alignment) {
+#ifdef __linux__
+        return bytes >= kHugePageSize && alignment <= kHugePageSize;
+#else
+        (void)bytes;
+        (void)alignment;
+        return false;
+#endif
+    }  // mapped()
+
+
+    static std::size_t roundUp(std::size_t bytes) {
+        return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    }  // roundUp()
+
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!mapped(bytes, alignment)) return upstream->allocate(bytes, alignment);
+#ifdef __linux__
+        const std::size_t length = roundUp(bytes);
+        void *block = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (block != MAP_FAILED) {
+            hugeTlb.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }  // if
+
+        // Transparent huge pages only fill aligned 2 MB ranges, so map one
+        // page extra and trim the ends to line the block up.
+        void *raw = mmap(nullptr, length + kHugePageSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) throw std::bad_alloc();
+        const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+        const std::uintptr_t aligned = (start + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+        if (aligned != start) munmap(raw, aligned - start);
+        munmap(reinterpret_cast<void *>(aligned + length), kHugePageSize - (aligned - start));
+        block = reinterpret_cast<void *>(aligned);
+        // Only a hint: it fails harmlessly where THP is disabled.
+        madvise(block, length, MADV_HUGEPAGE);
+        transparent.fetch_add(1, std::memory_order_relaxed);
+        return block;
+#else
+        return nullptr;
+#endif
+    }  // do_allocate()
+
+
+    void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override {
+        if (!mapped(bytes, alignment)) {
+            upstream->deallocate(block, bytes, alignment);
+            return;
+        }  // if
+#ifdef __linux__
+        munmap(block, roundUp(bytes));
+#endif
+    }  // do_deallocate()
+
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }  // do_is_equal()
+};  // HugePageResource
+
+#endif  // HUGEPAGERESOURCE_H
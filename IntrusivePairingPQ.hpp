@@ -0,0 +1,336 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef INTRUSIVEPAIRINGPQ_H
+#define INTRUSIVEPAIRINGPQ_H
+
+#include <stdexcept>
+#include <utility>
+
+#include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+
+// The links an object needs to sit in an IntrusivePairingPQ. Embed one in
+// the object and name it as the PQ's HOOK template argument:
+//
+//     struct Task {
+//         int priority;
+//         PairingHook<Task> hook;
+//     };
+//     IntrusivePairingPQ<Task, &Task::hook, TaskLess> pq;
+//
+// An object can be in at most one PQ per hook it embeds.
+template<typename TYPE>
+struct PairingHook {
+    // Leftmost child.
+    TYPE *child = nullptr;
+
+    // Next sibling in the parent's child list.
+    TYPE *sibling = nullptr;
+
+    // Previous sibling, or the parent for a leftmost child, so a node can
+    // be cut in O(1) without a separate parent pointer. nullptr for the
+    // root and for objects not in a PQ.
+    TYPE *prev = nullptr;
+};
+
+
+// A pairing heap that links the caller's objects through an embedded
+// PairingHook instead of copying them into nodes it allocates.
+//
+// The PQ holds TYPE* and never allocates, copies or frees an object: the
+// caller owns every object, must keep it alive and at the same address
+// while it is in the PQ, and must not change its priority except through
+// updateElt() (or by calling updatePriorities() afterwards). COMP_FUNCTOR
+// compares objects (const TYPE &), not pointers.
+//
+// push/top are O(1), pop and erase are O(log n) amortized, and updateElt is
+// O(1) plus the amortized cost the pairing heap defers to the next pop.
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp).
+template<typename TYPE, PairingHook<TYPE> TYPE::*HOOK, typename COMP_FUNCTOR = std::less<TYPE>,
+         typename INSTRUMENT = NullInstrument>
+class IntrusivePairingPQ : public Eecs281PQ<TYPE*, COMP_FUNCTOR> {
+    using BaseClass = Eecs281PQ<TYPE*, COMP_FUNCTOR>;
+
+public:
+    // ============================
+    // Constructors, destructor
+    // ============================
+    explicit IntrusivePairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, root(nullptr), numNodes(0) {}
+
+    template<typename InputIterator>
+    IntrusivePairingPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, root(nullptr), numNodes(0) {
+        for (; start != end; ++start) {
+            push(*start);
+        }
+    }
+
+    // An object can only be linked into one PQ, so there is nothing a copy
+    // could hold; moving hands the objects over.
+    IntrusivePairingPQ(const IntrusivePairingPQ &) = delete;
+    IntrusivePairingPQ &operator=(const IntrusivePairingPQ &) = delete;
+
+    IntrusivePairingPQ(IntrusivePairingPQ &&other) noexcept
+      : BaseClass{other.compare}, root(other.root), numNodes(other.numNodes) {
+        other.root = nullptr;
+        other.numNodes = 0;
+    }
+
+    IntrusivePairingPQ &operator=(IntrusivePairingPQ &&rhs) noexcept {
+        if (this != &rhs) {
+            clear();
+            this->compare = rhs.compare;
+            root = std::exchange(rhs.root, nullptr);
+            numNodes = std::exchange(rhs.numNodes, 0);
+        }
+        return *this;
+    }
+
+    // Unlinks (but does not free) every object still in the PQ.
+    ~IntrusivePairingPQ() {
+        clear();
+    }
+
+    // ============================
+    // Required interface
+    // ============================
+
+    // Link 'obj' into the PQ. It must not already be in one through HOOK.
+    virtual void push(TYPE * const &obj) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        hook(obj) = PairingHook<TYPE>{};
+        root = meld(root, obj);
+        ++numNodes;
+    }
+
+    // Unlink the most extreme object; it can be pushed again afterwards.
+    virtual void pop() {
+        if (!root) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+
+        TYPE *oldRoot = root;
+        root = mergeChildren(oldRoot);
+        --numNodes;
+    }
+
+    virtual TYPE * const &top() const {
+        if (!root) {
+            throw std::runtime_error("IntrusivePairingPQ: top() called on empty PQ!");
+        }
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
+        return root;
+    }
+
+    [[nodiscard]] virtual std::size_t size() const { return numNodes; }
+    [[nodiscard]] virtual bool empty() const { return (root == nullptr); }
+
+    // Rebuild the entire PQ after arbitrary changes to the objects'
+    // priorities: unlink every object, then pair them all up again.
+    virtual void updatePriorities() {
+        if (!root) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+
+        root = pairList(flatten());
+    }
+
+    // ============================
+    // Intrusive-specific interface
+    // ============================
+
+    // Call after making 'obj' more extreme in place. Making it less extreme
+    // this way breaks the heap; erase() it and push() it again instead.
+    void updateElt(TYPE *obj) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdateElt };
+        if (obj == root) return;
+
+        cut(obj);
+        root = meld(root, obj);
+    }
+
+    // Unlink 'obj', which must be in this PQ, wherever it is.
+    void erase(TYPE *obj) {
+        if (obj == root) {
+            pop();
+            return;
+        }
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+
+        cut(obj);
+        root = meld(root, mergeChildren(obj));
+        --numNodes;
+    }
+
+    // Move every object in 'other' into this PQ in O(1). Both PQs must
+    // order objects the same way; 'other' is left empty.
+    void meld(IntrusivePairingPQ &other) {
+        if (this == &other) return;
+        root = meld(root, other.root);
+        numNodes += other.numNodes;
+        other.root = nullptr;
+        other.numNodes = 0;
+    }
+
+    // True if 'obj' is in this PQ, provided it is not in another PQ through
+    // the same HOOK.
+    bool isLinked(const TYPE *obj) const {
+        return obj == root || (obj->*HOOK).prev != nullptr;
+    }
+
+    // Unlink every object more extreme than '*threshold' into 'out', most
+    // extreme first. 'threshold' need not be in the PQ. This hides
+    // Eecs281PQ::pop_above(), which would hand COMP_FUNCTOR the pointers.
+    template<typename OutputIterator>
+    OutputIterator pop_above(const TYPE *threshold, OutputIterator out) {
+        while (root && lowerPriority(threshold, root)) {
+            *out = root;
+            ++out;
+            pop();
+        }
+        return out;
+    }
+
+    // Unlink every object, leaving the PQ empty. O(n).
+    void clear() {
+        for (TYPE *list = flatten(); list; ) {
+            TYPE *next = hook(list).sibling;
+            hook(list).sibling = nullptr;
+            list = next;
+        }
+        numNodes = 0;
+    }
+
+    // Access the instrumentation policy, e.g. to dump() or reset() a
+    // CountingInstrument.
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+private:
+    TYPE *root;         // The root of the pairing heap
+    std::size_t numNodes;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // ============================
+    // Private helper functions
+    // ============================
+
+    static PairingHook<TYPE> &hook(TYPE *obj) {
+        return obj->*HOOK;
+    }
+
+    // this->compare on the objects, routed through the instrumentation
+    // policy.
+    bool lowerPriority(const TYPE *a, const TYPE *b) const {
+        instrument.countCompare();
+        return this->compare(*a, *b);
+    }
+
+    // Meld two trees, returning the resulting root. Both roots must have
+    // no siblings.
+    TYPE *meld(TYPE *first, TYPE *second) {
+        if (!first) return second;
+        if (!second) return first;
+
+        if (lowerPriority(first, second)) {
+            std::swap(first, second);
+        }
+        instrument.countMoves(1);
+
+        // Attach 'second' as the leftmost child of 'first'.
+        PairingHook<TYPE> &top = hook(first);
+        PairingHook<TYPE> &sub = hook(second);
+        sub.sibling = top.child;
+        sub.prev = first;
+        if (top.child) hook(top.child).prev = second;
+        top.child = second;
+        return first;
+    }
+
+    // Detach 'obj' and its subtree from its parent or left sibling.
+    // 'obj' must not be the root.
+    void cut(TYPE *obj) {
+        PairingHook<TYPE> &node = hook(obj);
+        PairingHook<TYPE> &prev = hook(node.prev);
+        if (prev.child == obj) {
+            prev.child = node.sibling;
+        } else {
+            prev.sibling = node.sibling;
+        }
+        if (node.sibling) hook(node.sibling).prev = node.prev;
+        node.sibling = nullptr;
+        node.prev = nullptr;
+    }
+
+    // Detach all children of 'obj' and pair them into a single tree,
+    // returning its root (nullptr if there were none). 'obj' is left with
+    // an empty hook.
+    TYPE *mergeChildren(TYPE *obj) {
+        TYPE *children = hook(obj).child;
+        hook(obj) = PairingHook<TYPE>{};
+        return pairList(children);
+    }
+
+    // Two-pass pairing of a sibling list: meld neighbours left to right,
+    // then meld the pairs right to left. The pairs are kept on a list
+    // threaded through their own sibling links, so nothing is allocated.
+    TYPE *pairList(TYPE *list) {
+        std::size_t count = 0;
+        TYPE *pairs = nullptr;  // Pairs, most recent first
+        while (list) {
+            TYPE *first = list;
+            TYPE *second = hook(first).sibling;
+            list = second ? hook(second).sibling : nullptr;
+            detach(first);
+            if (second) detach(second);
+
+            TYPE *pair = meld(first, second);
+            hook(pair).sibling = pairs;
+            pairs = pair;
+            count += second ? 2 : 1;
+        }
+        instrument.recordRootChildren(count);
+
+        TYPE *result = nullptr;
+        while (pairs) {
+            TYPE *pair = pairs;
+            pairs = hook(pair).sibling;
+            hook(pair).sibling = nullptr;
+            result = meld(pair, result);
+        }
+        return result;
+    }
+
+    // Unlink every object and thread them all onto one list through their
+    // sibling links, reusing the hooks so nothing is allocated. Returns the
+    // head of the list; the PQ is left with no root.
+    TYPE *flatten() {
+        TYPE *list = nullptr;
+        TYPE *pending = root;
+        while (pending) {
+            TYPE *curr = pending;
+            pending = hook(curr).sibling;
+            if (hook(curr).child) {
+                // Visit the children before the rest of 'pending'.
+                TYPE *last = hook(curr).child;
+                while (hook(last).sibling) last = hook(last).sibling;
+                hook(last).sibling = pending;
+                pending = hook(curr).child;
+            }
+            hook(curr) = PairingHook<TYPE>{};
+            hook(curr).sibling = list;
+            list = curr;
+        }
+        root = nullptr;
+        return list;
+    }
+
+    // Clear an object's sibling links so it can be melded as a root.
+    static void detach(TYPE *obj) {
+        hook(obj).sibling = nullptr;
+        hook(obj).prev = nullptr;
+    }
+};
+
+#endif  // INTRUSIVEPAIRINGPQ_H
@@ -0,0 +1,186 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef LOSERTREE_H
+#define LOSERTREE_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// A tournament tree of losers over a fixed number of sources, built for
+// k-way merging: each source (a sorted run, a shard, ...) contributes its
+// current head, and top() is the most extreme (defined by 'compare') head.
+//
+// Every internal node remembers the loser of the match played there, and
+// the overall winner is kept above the root. When the winner's source
+// produces its next element, replace_top() replays only the matches on that
+// source's leaf-to-root path against the stored losers: at most ceil(log k)
+// comparisons and no element moves, where a BinaryPQ needs up to 2 log k
+// comparisons and an element swap per level. A source that runs dry is
+// marked exhausted with exhaust_top() and loses every match from then on,
+// so no sentinel value of TYPE is needed.
+//
+// Ties go to the lower-numbered source, so merging runs given in order is
+// stable. TYPE only needs to be copy constructible: a source has no head
+// until it is primed.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class LoserTree {
+public:
+    // Description: Construct a tree over k sources, all of them exhausted
+    //              until given a head with prime().
+    // Runtime: O(k)
+    explicit LoserTree(std::size_t k, COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : compare { comp }, heads(k), exhausted(k, 1), losers(k, 0) {}
+
+
+    // Description: Give 'source' its first head. Call build() once every
+    //              source that has one is primed.
+    // Runtime: O(1)
+    void prime(std::size_t source, const TYPE &val) {
+        heads[source].emplace(val);
+        exhausted[source] = 0;
+    }  // prime()
+
+
+    // Description: Play every match to find the first winner.
+    // Runtime: O(k)
+    void build() {
+        const std::size_t k = heads.size();
+        if (k == 0) return;
+
+        // winners[node] is the winner below 'node'; leaves are k..2k-1.
+        std::vector<std::size_t> winners(2 * k);
+        for (std::size_t source = 0; source < k; ++source) {
+            winners[k + source] = source;
+        }  // for ..source
+        for (std::size_t node = k - 1; node > 0; --node) {
+            std::size_t left = winners[2 * node];
+            std::size_t right = winners[2 * node + 1];
+            if (beats(right, left)) std::swap(left, right);
+            winners[node] = left;
+            losers[node] = right;
+        }  // for ..node
+        losers[0] = winners[1];
+    }  // build()
+
+
+    // Description: Return the most extreme (defined by 'compare') head.
+    // Note: The tree must not be empty.
+    // Runtime: O(1)
+    const TYPE &top() const { return *heads[losers[0]]; }
+
+
+    // Description: Return the source whose head is top().
+    // Runtime: O(1)
+    [[nodiscard]] std::size_t topSource() const { return losers[0]; }
+
+
+    // Description: Replace the top with the next element of its source.
+    // Runtime: O(log(k))
+    void replace_top(const TYPE &val) {
+        heads[losers[0]].emplace(val);
+        replay(losers[0]);
+    }  // replace_top()
+
+
+    // Description: Mark the top's source as exhausted.
+    // Runtime: O(log(k))
+    void exhaust_top() {
+        exhausted[losers[0]] = 1;
+        replay(losers[0]);
+    }  // exhaust_top()
+
+
+    // Description: Return true if every source is exhausted.
+    // Runtime: O(1)
+    [[nodiscard]] bool empty() const { return heads.empty() || exhausted[losers[0]]; }
+
+
+    // Description: Get the number of sources, exhausted or not.
+    // Runtime: O(1)
+    [[nodiscard]] std::size_t sources() const { return heads.size(); }
+
+private:
+    COMP_FUNCTOR compare;
+    std::vector<std::optional<TYPE>> heads;
+    std::vector<char> exhausted;
+    // losers[node] for the internal nodes 1..k-1; losers[0] is the winner.
+    std::vector<std::size_t> losers;
+
+
+    // Description: Whether source a wins its match against source b: a live
+    //              source beats an exhausted one, and equal heads go to the
+    //              lower-numbered source. Costs at most one comparison.
+    bool beats(std::size_t a, std::size_t b) const {
+        if (exhausted[a] | exhausted[b]) return !exhausted[a] && exhausted[b];
+        // Put the lower-numbered source first with selects, not a branch.
+        const bool aFirst = a < b;
+        const bool firstLoses = compare(*heads[aFirst ? a : b], *heads[aFirst ? b : a]);
+        return aFirst != firstLoses;
+    }  // beats()
+
+
+    // Description: Replay the matches from source's leaf up to the root.
+    // Runtime: O(log(k))
+    void replay(std::size_t source) {
+        std::size_t winner = source;
+        for (std::size_t node = (heads.size() + source) / 2; node > 0; node /= 2) {
+            // Exchange the two with a mask: the outcome is a coin flip for
+            // merged random runs, so a branch here would mispredict half
+            // the time.
+            const std::size_t challenger = losers[node];
+            const std::size_t mask = std::size_t { 0 } - static_cast<std::size_t>(beats(challenger, winner));
+            const std::size_t change = (challenger ^ winner) & mask;
+            losers[node] = challenger ^ change;
+            winner ^= change;
+        }  // for ..node
+        losers[0] = winner;
+    }  // replay()
+};  // LoserTree
+
+
+// Description: Merge sorted runs into 'out'. Each run is a pair of input
+//              iterators, sorted by 'comp' (ascending for std::less); the
+//              output is sorted the same way, and equal elements keep the
+//              order of their runs. Returns the output iterator past the
+//              last element written.
+// Runtime: O(n log(k)) for n elements in k runs.
+template<typename InputIterator, typename OutputIterator,
+         typename COMP_FUNCTOR = std::less<typename std::iterator_traits<InputIterator>::value_type>>
+OutputIterator mergeRuns(std::vector<std::pair<InputIterator, InputIterator>> runs,
+                         OutputIterator out, COMP_FUNCTOR comp = COMP_FUNCTOR()) {
+    using TYPE = typename std::iterator_traits<InputIterator>::value_type;
+
+    // The tree puts the most extreme element on top, so reverse the order
+    // to have the least element come out first.
+    struct Reversed {
+        COMP_FUNCTOR comp;
+
+        bool operator()(const TYPE &a, const TYPE &b) const {
+            return comp(b, a);
+        }  // operator()()
+    };  // Reversed
+
+    LoserTree<TYPE, Reversed> tree { runs.size(), Reversed { comp } };
+    for (std::size_t source = 0; source < runs.size(); ++source) {
+        if (runs[source].first != runs[source].second) tree.prime(source, *runs[source].first);
+    }  // for ..source
+    tree.build();
+
+    while (!tree.empty()) {
+        std::pair<InputIterator, InputIterator> &run = runs[tree.topSource()];
+        *out = tree.top();
+        ++out;
+        if (++run.first != run.second) {
+            tree.replace_top(*run.first);
+        } else {
+            tree.exhaust_top();
+        }  // if
+    }  // while
+    return out;
+}  // mergeRuns()
+
+#endif  // LOSERTREE_H
@@ -0,0 +1,286 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef MINMAXPQ_H
+#define MINMAXPQ_H
+
+#include <algorithm>
+
+#include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+
+// A double-ended priority queue implemented as a min-max heap (Atkinson et
+// al., 1986) over a std::vector, in the same style as BinaryPQ.
+//
+// Nodes on even levels (the root is level 0) are at least as extreme as
+// everything below them; nodes on odd levels are at most as extreme as
+// everything below them. So top() is the root and bottom(), the least
+// extreme element, is the root or one of its two children.
+//
+// top()/pop() behave as in every other Eecs281PQ. pop_max() is an alias of
+// pop(), pop_min() removes bottom(), and push_bounded() gives a fixed-size
+// queue that evicts its least extreme element when full.
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp).
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+class MinMaxPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Description: Construct an empty PQ with an optional comparison functor.
+    // Runtime: O(1)
+    explicit MinMaxPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : BaseClass { comp } {}
+
+
+    // Description: Construct a PQ out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n) where n is number of elements in range.
+    template<typename InputIterator>
+    MinMaxPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : BaseClass { comp } {
+        data.assign(start, end);
+        updatePriorities();
+    }  // MinMaxPQ
+
+
+    // Description: Destructor, copy and move don't need any code, the data
+    //              vector is handled automatically.
+    virtual ~MinMaxPQ() = default;
+    MinMaxPQ(const MinMaxPQ &) = default;
+    MinMaxPQ(MinMaxPQ &&) noexcept = default;
+    MinMaxPQ &operator=(const MinMaxPQ &) = default;
+    MinMaxPQ &operator=(MinMaxPQ &&) noexcept = default;
+
+
+    // Description: Assumes that all elements inside the heap are out of order
+    //              and rebuilds it bottom-up, as BinaryPQ does.
+    // Runtime: O(n)
+    virtual void updatePriorities() {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+        for (std::size_t i = data.size() / 2; i-- > 0;) {
+            fixDown(i);
+        }  // for ..i
+    }  // updatePriorities()
+
+
+    // Description: Add a new element to the PQ.
+    // Runtime: O(log(n))
+    virtual void push(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        data.push_back(val);
+        fixUp(data.size() - 1);
+    }  // push()
+
+
+    // Description: Remove the most extreme element from the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: O(log(n))
+    virtual void pop() {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+        removeAt(0);
+    }  // pop()
+
+
+    // Description: Same as pop(), named for symmetry with pop_min().
+    // Runtime: O(log(n))
+    void pop_max() { pop(); }
+
+
+    // Description: Remove the least extreme element from the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: O(log(n))
+    void pop_min() {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+        removeAt(bottomIndex());
+    }  // pop_min()
+
+
+    // Description: Return the most extreme element of the PQ.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
+        return data.front();
+    }  // top()
+
+
+    // Description: Return the least extreme element of the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: O(1)
+    const TYPE &bottom() const {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
+        return data[bottomIndex()];
+    }  // bottom()
+
+
+    // Description: Push val into a queue bounded to 'capacity' elements. If
+    //              the queue is already full, whichever of val and bottom()
+    //              is less extreme is dropped. Returns true if val was kept.
+    // Runtime: O(log(n))
+    bool push_bounded(const TYPE &val, std::size_t capacity) {
+        if (data.size() < capacity) {
+            push(val);
+            return true;
+        }  // if
+        if (data.empty()) return false;
+
+        typename INSTRUMENT::Scope scope { instrument, PQOp::ReplaceTop };
+        const std::size_t i = bottomIndex();
+        if (!lowerPriority(data[i], val)) return false;
+
+        data[i] = val;
+        instrument.countMoves(1);
+        if (i != 0 && lowerPriority(data[0], data[i])) {
+            std::swap(data[0], data[i]);
+            instrument.countMoves(1);
+        }  // if
+        fixDown(i);
+        return true;
+    }  // push_bounded()
+
+
+    // Description: Get the number of elements in the PQ.
+    // Runtime: O(1)
+    [[nodiscard]] virtual std::size_t size() const { return data.size(); }
+
+
+    // Description: Return true if the PQ is empty.
+    // Runtime: O(1)
+    [[nodiscard]] virtual bool empty() const { return data.empty(); }
+
+
+    // Description: Access the instrumentation policy, e.g. to dump() or
+    //              reset() a CountingInstrument.
+    // Runtime: O(1)
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+
+private:
+    std::vector<TYPE> data;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // Description: this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }  // lowerPriority()
+
+    // Description: True if a is strictly more extreme than b in the
+    //              direction of the level: towards the top on max levels,
+    //              towards the bottom on min levels.
+    template<bool MAX_LEVEL>
+    bool beats(const TYPE &a, const TYPE &b) const {
+        return MAX_LEVEL ? lowerPriority(b, a) : lowerPriority(a, b);
+    }  // beats()
+
+    static bool isMaxLevel(std::size_t i) {
+        bool maxLevel = true;
+        for (++i; i > 1; i >>= 1) {
+            maxLevel = !maxLevel;
+        }  // for ..i
+        return maxLevel;
+    }  // isMaxLevel()
+
+    std::size_t bottomIndex() const {
+        if (data.size() <= 2) return data.size() - 1;
+        return lowerPriority(data[2], data[1]) ? 2 : 1;
+    }  // bottomIndex()
+
+    void swapSlots(std::size_t a, std::size_t b) {
+        std::swap(data[a], data[b]);
+        instrument.countMoves(1);
+    }  // swapSlots()
+
+    // Description: Remove the element at index i by moving the last element
+    //              into its place and trickling it down.
+    void removeAt(std::size_t i) {
+        if (i != data.size() - 1) {
+            data[i] = std::move(data.back());
+            instrument.countMoves(1);
+        }  // if
+        data.pop_back();
+        if (i < data.size()) fixDown(i);
+    }  // removeAt()
+
+    void fixUp(std::size_t i) {
+        if (i == 0) return;
+
+        const std::size_t parent = (i - 1) / 2;
+        if (isMaxLevel(i)) {
+            // The parent is on a min level: if we belong below it, go there.
+            if (lowerPriority(data[i], data[parent])) {
+                swapSlots(i, parent);
+                bubbleUp<false>(parent);
+            } else {
+                bubbleUp<true>(i);
+            }  // if
+        } else {
+            if (lowerPriority(data[parent], data[i])) {
+                swapSlots(i, parent);
+                bubbleUp<true>(parent);
+            } else {
+                bubbleUp<false>(i);
+            }  // if
+        }  // if
+    }  // fixUp()
+
+    // Description: Move i up through its grandparents, which are on the same
+    //              kind of level, while it beats them.
+    template<bool MAX_LEVEL>
+    void bubbleUp(std::size_t i) {
+        while (i > 2) {
+            const std::size_t grandparent = ((i - 1) / 2 - 1) / 2;
+            if (!beats<MAX_LEVEL>(data[i], data[grandparent])) break;
+            swapSlots(i, grandparent);
+            i = grandparent;
+        }  // while
+    }  // bubbleUp()
+
+    void fixDown(std::size_t i) {
+        if (isMaxLevel(i)) {
+            trickleDown<true>(i);
+        } else {
+            trickleDown<false>(i);
+        }  // if
+    }  // fixDown()
+
+    // Description: Restore the heap below i, where i is on a max level if
+    //              MAX_LEVEL, else on a min level.
+    template<bool MAX_LEVEL>
+    void trickleDown(std::size_t i) {
+        const std::size_t size = data.size();
+        while (2 * i + 1 < size) {
+            // Find the best of the (up to) two children and four grandchildren.
+            std::size_t best = 2 * i + 1;
+            if (best + 1 < size && beats<MAX_LEVEL>(data[best + 1], data[best])) {
+                best = best + 1;
+            }  // if
+
+            bool grandchild = false;
+            const std::size_t firstGrandchild = 4 * i + 3;
+            const std::size_t lastGrandchild = std::min(firstGrandchild + 4, size);
+            for (std::size_t g = firstGrandchild; g < lastGrandchild; ++g) {
+                if (beats<MAX_LEVEL>(data[g], data[best])) {
+                    best = g;
+                    grandchild = true;
+                }  // if
+            }  // for ..g
+
+            if (!beats<MAX_LEVEL>(data[best], data[i])) return;
+            swapSlots(i, best);
+            if (!grandchild) return;
+
+            // The element we pushed down may now be on the wrong side of
+            // best's parent, which is on the opposite kind of level.
+            const std::size_t parent = (best - 1) / 2;
+            if (beats<MAX_LEVEL>(data[parent], data[best])) {
+                swapSlots(parent, best);
+            }  // if
+            i = best;
+        }  // while
+    }  // trickleDown()
+};  // MinMaxPQ
+
+#endif  // MINMAXPQ_H
@@ -0,0 +1,213 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef PQINSTRUMENT_H
+#define PQINSTRUMENT_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Instrumentation policies for the priority queues.
+//
+// Every PQ takes an INSTRUMENT template parameter that defaults to
+// NullInstrument, whose hooks are empty inline functions, so the default
+// instantiation compiles to exactly the same hot path as before. Swapping in
+// CountingInstrument counts comparisons, element moves, node allocations and
+// pairing-heap root fan-out, and records per-operation latency.
+//
+// A policy must provide:
+//   countCompare()              one call through this->compare
+//   countMoves(n)               n element moves or swaps in a sift/meld path
+//   countAllocation()           one node allocated by a node-based PQ
+//   recordRootChildren(n)       length of the root's child list on pop
+//   Scope(policy &, PQOp)       RAII guard placed around a public operation
+
+
+// Operations whose latency an instrumentation policy can record.
+enum class PQOp : std::size_t {
+    Push,
+    Pop,
+    Top,
+    UpdatePriorities,
+    UpdateElt,
+    ReplaceTop,
+};
+
+static const std::size_t kNumPQOps = 6;
+
+inline const char *pqOpName(PQOp op) {
+    switch (op) {
+    case PQOp::Push:
+        return "push";
+    case PQOp::Pop:
+        return "pop";
+    case PQOp::Top:
+        return "top";
+    case PQOp::UpdatePriorities:
+        return "updatePriorities";
+    case PQOp::UpdateElt:
+        return "updateElt";
+    case PQOp::ReplaceTop:
+        return "replace_top";
+    }  // switch
+
+    return "unknown";
+}  // pqOpName()
+
+
+// The default policy: every hook is empty and the Scope guard holds nothing.
+struct NullInstrument {
+    struct Scope {
+        constexpr Scope(NullInstrument &, PQOp) {}
+    };  // Scope
+
+    void countCompare() {}
+    void countMoves(std::size_t) {}
+    void countAllocation() {}
+    void recordRootChildren(std::size_t) {}
+};  // NullInstrument
+
+
+// A log-linear histogram in the style of HdrHistogram: values below 32 get
+// their own bucket, and every power of two above that is split into 32
+// sub-buckets, so any recorded value is reported within ~3% of its true
+// magnitude using a fixed 1920-slot table and no allocation.
+class LogHistogram {
+public:
+    void record(std::uint64_t value) {
+        ++counts[bucketOf(value)];
+        ++total;
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }  // record()
+
+    [[nodiscard]] std::uint64_t count() const { return total; }
+    [[nodiscard]] std::uint64_t min() const { return total ? minValue : 0; }
+    [[nodiscard]] std::uint64_t max() const { return maxValue; }
+
+    // Description: Return the smallest bucket value v such that at least
+    //              'percent' percent of the recorded values are <= v.
+    // Runtime: O(number of buckets)
+    [[nodiscard]] std::uint64_t percentile(double percent) const {
+        if (total == 0) return 0;
+        auto wanted = static_cast<std::uint64_t>(percent / 100.0 * static_cast<double>(total));
+        if (wanted == 0) wanted = 1;
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kNumBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= wanted) return valueOf(i);
+        }  // for ..i
+
+        return maxValue;
+    }  // percentile()
+
+    void reset() { *this = LogHistogram {}; }
+
+private:
+    static const unsigned kSubBits = 5;
+    static const std::uint64_t kSubCount = std::uint64_t { 1 } << kSubBits;
+    static const std::size_t kNumBuckets = kSubCount + (64 - kSubBits) * kSubCount;
+
+    std::array<std::uint64_t, kNumBuckets> counts {};
+    std::uint64_t total = 0;
+    std::uint64_t minValue = UINT64_MAX;
+    std::uint64_t maxValue = 0;
+
+    static std::size_t bucketOf(std::uint64_t value) {
+        if (value < kSubCount) return static_cast<std::size_t>(value);
+
+        unsigned magnitude = 63;
+        while (!(value >> magnitude)) --magnitude;
+        const unsigned shift = magnitude - kSubBits;
+        const std::uint64_t sub = (value >> shift) - kSubCount;
+        return static_cast<std::size_t>(kSubCount + shift * kSubCount + sub);
+    }  // bucketOf()
+
+    static std::uint64_t valueOf(std::size_t bucket) {
+        if (bucket < kSubCount) return bucket;
+
+        const std::size_t shift = (bucket - kSubCount) / kSubCount;
+        const std::uint64_t sub = (bucket - kSubCount) % kSubCount;
+        return (kSubCount + sub) << shift;
+    }  // valueOf()
+};  // LogHistogram
+
+
+// A policy that counts everything and times every public operation with
+// std::chrono::steady_clock. Dump it with dump(std::cout) whenever needed.
+class CountingInstrument {
+public:
+    class Scope {
+    public:
+        Scope(CountingInstrument &owner, PQOp op)
+            : owner { owner }
+            , op { op }
+            , start { std::chrono::steady_clock::now() } {}
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope() {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            owner.latencies[static_cast<std::size_t>(op)].record(static_cast<std::uint64_t>(ns));
+        }  // ~Scope()
+
+    private:
+        CountingInstrument &owner;
+        PQOp op;
+        std::chrono::steady_clock::time_point start;
+    };  // Scope
+
+    void countCompare() { ++compares; }
+    void countMoves(std::size_t n) { moves += n; }
+    void countAllocation() { ++allocations; }
+    void recordRootChildren(std::size_t n) { rootChildren.record(n); }
+
+    [[nodiscard]] std::uint64_t compareCount() const { return compares; }
+    [[nodiscard]] std::uint64_t moveCount() const { return moves; }
+    [[nodiscard]] std::uint64_t allocationCount() const { return allocations; }
+    [[nodiscard]] const LogHistogram &rootChildHistogram() const { return rootChildren; }
+    [[nodiscard]] const LogHistogram &latency(PQOp op) const {
+        return latencies[static_cast<std::size_t>(op)];
+    }  // latency()
+
+    void reset() { *this = CountingInstrument {}; }
+
+    // Description: Print the counters and a latency summary (in nanoseconds)
+    //              for every operation that was called at least once.
+    void dump(std::ostream &os) const {
+        os << "compares: " << compares << '\n'
+           << "moves: " << moves << '\n'
+           << "allocations: " << allocations << '\n';
+        if (rootChildren.count()) {
+            os << "root children on pop: p50 " << rootChildren.percentile(50)
+               << ", p99 " << rootChildren.percentile(99)
+               << ", max " << rootChildren.max() << '\n';
+        }  // if
+
+        for (std::size_t i = 0; i < kNumPQOps; ++i) {
+            const LogHistogram &h = latencies[i];
+            if (!h.count()) continue;
+            os << pqOpName(static_cast<PQOp>(i)) << ": n=" << h.count()
+               << " min=" << h.min()
+               << " p50=" << h.percentile(50)
+               << " p90=" << h.percentile(90)
+               << " p99=" << h.percentile(99)
+               << " p99.9=" << h.percentile(99.9)
+               << " max=" << h.max() << " ns\n";
+        }  // for ..i
+    }  // dump()
+
+private:
+    std::uint64_t compares = 0;
+    std::uint64_t moves = 0;
+    std::uint64_t allocations = 0;
+    LogHistogram rootChildren;
+    std::array<LogHistogram, kNumPQOps> latencies;
+};  // CountingInstrument
+
+#endif  // PQINSTRUMENT_H
@@ -0,0 +1,244 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef PQSNAPSHOT_H
+#define PQSNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary snapshots of PQ contents, used by the save()/load() members.
+//
+// A snapshot is a fixed header followed by a payload. For the vector-backed
+// queues the payload is the data vector written verbatim, in whatever order
+// the queue keeps it (heap order, sorted order, or no order), so loading it
+// back into the same kind of queue is a single read with no re-heapify or
+// re-sort. PairingPQ writes its elements in preorder followed by one shape
+// byte per node (has a child, has a next sibling), so the tree can be
+// relinked in linear time.
+//
+// Elements are copied as raw bytes, so TYPE must be trivially copyable, and
+// snapshots are only portable between builds with the same TYPE layout and
+// byte order (both are recorded in the header and checked on load).
+//
+// Header layout:
+//   char[8]   magic "PQSNAP\0\0"
+//   uint32    format version
+//   uint32    byte order marker 0x01020304
+//   uint32    SnapshotKind
+//   uint32    reserved (0)
+//   uint64    sizeof(TYPE)
+//   uint64    number of elements
+//   uint64    FNV-1a checksum of the payload and the fields above
+//
+// Payload:
+//   TYPE[count]     the elements
+//   uint8[count]    Pairing snapshots only: shape bits, see kSnapshotHasChild
+
+// How the elements in a snapshot's payload are arranged.
+enum class SnapshotKind : std::uint32_t {
+    Unordered = 1,  // any order (UnorderedPQ, UnorderedFastPQ)
+    Heap = 2,       // binary max-heap order (BinaryPQ)
+    Sorted = 3,     // sorted, most extreme last (SortedPQ)
+    Pairing = 4,    // pairing heap in preorder, plus shape bytes
+};
+
+// Shape bits of a Pairing snapshot node.
+static const unsigned char kSnapshotHasChild = 1;
+static const unsigned char kSnapshotHasSibling = 2;
+
+
+// 64-bit FNV-1a over everything fed to update(), in order.
+class SnapshotHasher {
+public:
+    void update(const void *bytes, std::size_t count) {
+        const auto *p = static_cast<const unsigned char *>(bytes);
+        for (std::size_t i = 0; i < count; ++i) {
+            hash = (hash ^ p[i]) * 0x100000001b3ULL;
+        }  // for ..i
+    }  // update()
+
+    [[nodiscard]] std::uint64_t value() const { return hash; }
+
+private:
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+};  // SnapshotHasher
+
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t kind;
+    std::uint32_t reserved;
+    std::uint64_t elementSize;
+    std::uint64_t count;
+    std::uint64_t checksum;
+};  // SnapshotHeader
+
+static const char kSnapshotMagic[8] = { 'P', 'Q', 'S', 'N', 'A', 'P', '\0', '\0' };
+static const std::uint32_t kSnapshotVersion = 1;
+static const std::uint32_t kSnapshotByteOrder = 0x01020304;
+
+
+// Description: Fill in a header for 'count' elements of TYPE; the checksum
+//              is finished from the payload hash by finishSnapshotChecksum().
+template<typename TYPE>
+SnapshotHeader makeSnapshotHeader(SnapshotKind kind, std::size_t count) {
+    SnapshotHeader header {};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.byteOrder = kSnapshotByteOrder;
+    header.kind = static_cast<std::uint32_t>(kind);
+    header.elementSize = sizeof(TYPE);
+    header.count = count;
+    return header;
+}  // makeSnapshotHeader()
+
+
+// Description: Mix the header fields into a payload hash, so a snapshot whose
+//              kind or count was corrupted fails the checksum too.
+inline std::uint64_t finishSnapshotChecksum(SnapshotHasher hasher, const SnapshotHeader &header) {
+    hasher.update(&header.version, sizeof(header.version));
+    hasher.update(&header.kind, sizeof(header.kind));
+    hasher.update(&header.elementSize, sizeof(header.elementSize));
+    hasher.update(&header.count, sizeof(header.count));
+    return hasher.value();
+}  // finishSnapshotChecksum()
+
+
+// Description: Open 'path' for reading and validate everything in its header
+//              except the checksum, which needs the payload.
+// Throws: std::runtime_error if the file can't be read or isn't a snapshot
+//         of TYPE written by this build.
+template<typename TYPE>
+SnapshotHeader readSnapshotHeader(std::ifstream &in, const std::string &path) {
+    static_assert(std::is_trivially_copyable<TYPE>::value,
+                  "PQ snapshots require a trivially copyable TYPE");
+
+    in.open(path, std::ios::binary);
+    if (!in) throw std::runtime_error("PQ snapshot: cannot open " + path);
+
+    SnapshotHeader header {};
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        throw std::runtime_error("PQ snapshot: truncated header in " + path);
+    }  // if
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+        throw std::runtime_error("PQ snapshot: bad magic in " + path);
+    }  // if
+    if (header.version != kSnapshotVersion) {
+        throw std::runtime_error("PQ snapshot: unsupported version in " + path);
+    }  // if
+    if (header.byteOrder != kSnapshotByteOrder) {
+        throw std::runtime_error("PQ snapshot: written with a different byte order: " + path);
+    }  // if
+    if (header.elementSize != sizeof(TYPE)) {
+        throw std::runtime_error("PQ snapshot: element size mismatch in " + path);
+    }  // if
+
+    return header;
+}  // readSnapshotHeader()
+
+
+// Description: Write 'count' elements starting at 'elements' as a snapshot
+//              of the given kind. A Pairing snapshot also passes its 'count'
+//              shape bytes.
+// Throws: std::runtime_error if the file can't be written.
+template<typename TYPE>
+void writeSnapshot(const std::string &path, SnapshotKind kind, const TYPE *elements,
+                   std::size_t count, const unsigned char *shape = nullptr) {
+    static_assert(std::is_trivially_copyable<TYPE>::value,
+                  "PQ snapshots require a trivially copyable TYPE");
+
+    SnapshotHeader header = makeSnapshotHeader<TYPE>(kind, count);
+    SnapshotHasher hasher;
+    hasher.update(elements, count * sizeof(TYPE));
+    if (shape) hasher.update(shape, count);
+    header.checksum = finishSnapshotChecksum(hasher, header);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(elements),
+              static_cast<std::streamsize>(count * sizeof(TYPE)));
+    if (shape) out.write(reinterpret_cast<const char *>(shape), static_cast<std::streamsize>(count));
+    out.close();
+    if (!out) throw std::runtime_error("PQ snapshot: failed writing " + path);
+}  // writeSnapshot()
+
+
+// Description: Read any snapshot into 'data' (and, for a Pairing snapshot,
+//              its shape bytes into 'shape'; otherwise 'shape' is left
+//              empty), replacing their contents. Returns the kind the
+//              snapshot was saved as.
+// Throws: std::runtime_error on I/O errors, a header mismatch, a payload
+//         whose length doesn't match the count (checked before anything
+//         is allocated) or a checksum mismatch. Both vectors are left
+//         empty on error.
+template<typename TYPE, typename ALLOC>
+SnapshotKind readSnapshot(const std::string &path, std::vector<TYPE, ALLOC> &data,
+                          std::vector<unsigned char> &shape) {
+    data.clear();
+    shape.clear();
+    std::ifstream in;
+    const SnapshotHeader header = readSnapshotHeader<TYPE>(in, path);
+    const bool hasShape = header.kind == static_cast<std::uint32_t>(SnapshotKind::Pairing);
+
+    // Check the count against the payload actually there before allocating
+    // anything, so a corrupted count can't ask for gigabytes.
+    const std::streampos payloadStart = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streamoff payloadLength = in.tellg() - payloadStart;
+    in.seekg(payloadStart);
+    const std::uint64_t bytesPerElement = sizeof(TYPE) + (hasShape ? 1 : 0);
+    if (!in || payloadLength < 0
+        || header.count > static_cast<std::uint64_t>(std::numeric_limits<std::streamoff>::max()) / bytesPerElement
+        || header.count * bytesPerElement != static_cast<std::uint64_t>(payloadLength)) {
+        throw std::runtime_error("PQ snapshot: truncated payload in " + path);
+    }  // if
+
+    data.resize(static_cast<std::size_t>(header.count));
+    if (hasShape) shape.resize(data.size());
+    const auto bytes = static_cast<std::streamsize>(data.size() * sizeof(TYPE));
+    if (!in.read(reinterpret_cast<char *>(data.data()), bytes)
+        || !in.read(reinterpret_cast<char *>(shape.data()), static_cast<std::streamsize>(shape.size()))) {
+        data.clear();
+        shape.clear();
+        throw std::runtime_error("PQ snapshot: truncated payload in " + path);
+    }  // if
+
+    SnapshotHasher hasher;
+    hasher.update(data.data(), data.size() * sizeof(TYPE));
+    hasher.update(shape.data(), shape.size());
+    if (finishSnapshotChecksum(hasher, header) != header.checksum) {
+        data.clear();
+        shape.clear();
+        throw std::runtime_error("PQ snapshot: checksum mismatch in " + path);
+    }  // if
+
+    return static_cast<SnapshotKind>(header.kind);
+}  // readSnapshot()
+
+
+// Description: Read an array snapshot (any kind but Pairing) into 'data' with
+//              a single read, replacing its contents, and return the kind
+//              it was saved as so the caller can decide whether it needs to
+//              restore its own invariant.
+// Throws: std::runtime_error as readSnapshot() does, or for a Pairing
+//         snapshot. 'data' is left empty on error.
+template<typename TYPE, typename ALLOC>
+SnapshotKind readArraySnapshot(const std::string &path, std::vector<TYPE, ALLOC> &data) {
+    std::vector<unsigned char> shape;
+    const SnapshotKind kind = readSnapshot(path, data, shape);
+    if (kind == SnapshotKind::Pairing) {
+        data.clear();
+        throw std::runtime_error("PQ snapshot: pairing-heap snapshot is not an array: " + path);
+    }  // if
+    return kind;
+}  // readArraySnapshot()
+
+#endif  // PQSNAPSHOT_H
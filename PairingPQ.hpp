@@ -3,12 +3,22 @@
 #ifndef PAIRINGPQ_H
 #define PAIRINGPQ_H
 
+#include <algorithm>
 #include <deque>
+#include <memory>
+#include <memory_resource>
 #include <utility>
+#include <vector>
 #include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+#include "PQSnapshot.hpp"
 
 // A specialized version of the priority queue ADT implemented as a pairing heap.
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp). ALLOC,
+// rebound to Node, allocates the nodes; pmr::PairingPQ (below) draws them
+// from a std::pmr::memory_resource.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument,
+         typename ALLOC = std::allocator<TYPE>>
 class PairingPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
 
@@ -46,12 +56,13 @@ public:
     // ============================
     // Constructors, destructor
     // ============================
-    explicit PairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
-      : BaseClass{comp}, root(nullptr), numNodes(0) {}
+    explicit PairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(), const ALLOC &alloc = ALLOC())
+      : BaseClass{comp}, root(nullptr), numNodes(0), nodeAllocator(alloc) {}
 
     template<typename InputIterator>
-    PairingPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
-      : BaseClass{comp}, root(nullptr), numNodes(0) {
+    PairingPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+              const ALLOC &alloc = ALLOC())
+      : BaseClass{comp}, root(nullptr), numNodes(0), nodeAllocator(alloc) {
         for (; start != end; ++start) {
             push(*start);
         }
@@ -59,7 +70,11 @@ public:
 
     // Copy constructor
     PairingPQ(const PairingPQ &other)
-      : BaseClass{other.compare}, root(nullptr), numNodes(0) {
+      : PairingPQ(other, NodeTraits::select_on_container_copy_construction(other.nodeAllocator)) {}
+
+    // Copy constructor with the nodes allocated by 'alloc'
+    PairingPQ(const PairingPQ &other, const ALLOC &alloc)
+      : BaseClass{other.compare}, root(nullptr), numNodes(0), nodeAllocator(alloc) {
         // Collect all nodes from 'other'
         std::deque<Node*> nodes;
         collectNodes(other.root, nodes);
@@ -72,9 +87,11 @@ public:
     // Copy-assignment operator
     PairingPQ &operator=(const PairingPQ &rhs) {
         if (this != &rhs) {
-            PairingPQ temp(rhs);
+            // Built with our allocator, so that we can free its nodes.
+            PairingPQ temp(rhs, get_allocator());
             std::swap(root, temp.root);
             std::swap(numNodes, temp.numNodes);
+            dirtyNodes.clear();
         }
         return *this;
     }
@@ -93,45 +110,35 @@ public:
 
     virtual void pop() {
         if (!root) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
 
         Node *oldRoot = root;
+        root = mergeChildren(oldRoot);
 
-        // Gather the children of the root in a deque
-        std::deque<Node*> childList;
-        Node *curr = root->child;
-        while (curr) {
-            Node *next = curr->sibling;
-            // Detach each child from the old root
-            curr->parent = nullptr;
-            curr->prev   = nullptr;
-            curr->sibling = nullptr;
-            childList.push_back(curr);
-            curr = next;
-        }
-
-        delete oldRoot;
+        deleteNode(oldRoot);
         --numNodes;
-        root = nullptr;
-
-        // Meld children pairwise
-        while (childList.size() > 1) {
-            Node *first = childList.front(); 
-            childList.pop_front();
-            Node *second = childList.front();
-            childList.pop_front();
+    }
 
-            childList.push_back(meld(first, second));
-        }
-        // If there's exactly one child left
-        if (!childList.empty()) {
-            root = childList.front();
-        }
+    // Replace the most extreme element with val, equivalent to pop() followed
+    // by push(val) but reusing the root's node instead of freeing one and
+    // allocating another. Returns the handle now holding val; any handle to
+    // the old root refers to that same node afterwards.
+    // Note: The PQ must not be empty.
+    Node *replace_top(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::ReplaceTop };
+
+        Node *node = root;
+        Node *rest = mergeChildren(node);
+        node->elt = val;
+        root = meld(node, rest);
+        return node;
     }
 
     virtual const TYPE &top() const {
         if (!root) {
             throw std::runtime_error("PairingPQ: top() called on empty PQ!");
         }
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
         return root->elt;
     }
 
@@ -143,9 +150,10 @@ public:
     // ============================
     void updateElt(Node *node, const TYPE &new_value) {
         if (!node) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdateElt };
 
         // For a max-heap, we only "bubble up" if the new_value is larger
-        if (!this->compare(node->elt, new_value)) {
+        if (!lowerPriority(node->elt, new_value)) {
             // means node->elt >= new_value => no increase => do nothing
             return;
         }
@@ -153,34 +161,164 @@ public:
 
         // If it's already the root, no need to re-meld
         if (node != root) {
-            // 1) Cut 'node' from its parent's child list in O(1)
-            Node *parent = node->parent;
+            cut(node);
+            root = meld(root, node);
+        }
+    }
 
-            // If we have a previous sibling, fix that
-            if (node->prev) {
-                node->prev->sibling = node->sibling;
+    // Set many nodes' elements at once from [first, last), a range of
+    // {Node *, new value} pairs (a later pair for the same node wins).
+    // Unlike updateElt(), priorities may move in either direction. Every
+    // affected node is cut out first: with its subtree if it rose, on its
+    // own (children detached) if it fell. Those trees are paired among
+    // themselves in one multipass and the result is melded into the root
+    // once, so the root's child list grows by one rather than by one per
+    // node. Falls back to updatePriorities() when the batch is at least
+    // half the heap.
+    template<typename InputIterator>
+    void updateElts(InputIterator first, InputIterator last) {
+        std::vector<std::pair<Node*, bool>> changed;  // node, may have fallen
+        for (; first != last; ++first) {
+            Node *node = first->first;
+            if (!node) continue;
+            changed.emplace_back(node, !lowerPriority(node->elt, first->second));
+            node->elt = first->second;
+        }
+        if (changed.empty()) return;
+        if (changed.size() >= numNodes / 2) {
+            updatePriorities();
+            return;
+        }
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdateElt };
+
+        // Cut every node before detaching any children, so that a changed
+        // node below another one is always cut from its own parent.
+        Node *rest = root;
+        for (const auto &change : changed) {
+            if (change.first == root) {
+                rest = nullptr;
+            } else {
+                cut(change.first);
+            }
+        }
+
+        // A cut node's prev is null; pointing it at the node itself marks
+        // it as queued, so that repeated nodes are queued once.
+        std::deque<Node*> trees;
+        for (const auto &[node, fell] : changed) {
+            if (fell) {
+                Node *curr = node->child;
+                while (curr) {
+                    Node *sibling = curr->sibling;
+                    curr->parent = nullptr;
+                    curr->prev = nullptr;
+                    curr->sibling = nullptr;
+                    trees.push_back(curr);
+                    curr = sibling;
+                }
+                node->child = nullptr;
             }
-            // If we have a next sibling, fix that
-            if (node->sibling) {
-                node->sibling->prev = node->prev;
+            if (node->prev != node) {
+                node->prev = node;
+                trees.push_back(node);
             }
-            // If this node was the direct child of the parent, update that pointer
-            if (parent && parent->child == node) {
-                parent->child = node->sibling;
+        }
+        for (const auto &change : changed) {
+            change.first->prev = nullptr;
+        }
+        root = meld(rest, pairTrees(trees));
+    }
+
+    // Pop every element for which pred(element) is true into 'out', most
+    // extreme first, and return the iterator past the last one written. pred
+    // must accept a prefix of the priority order (see
+    // Eecs281PQ::drain_while()), so the accepted nodes form a tree at the
+    // root: they are taken out in one walk, and the subtrees hanging off
+    // them are paired into the new heap once, rather than once per pop.
+    // Handles to drained nodes are invalidated, as by pop().
+    template<typename PREDICATE, typename OutputIterator>
+    OutputIterator drain_while(PREDICATE pred, OutputIterator out) {
+        if (!root || !pred(root->elt)) return out;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+
+        std::vector<Node*> taken { root };
+        std::deque<Node*> rest;
+        for (std::size_t next = 0; next < taken.size(); ++next) {
+            Node *curr = taken[next]->child;
+            while (curr) {
+                Node *sibling = curr->sibling;
+                curr->parent = nullptr;
+                curr->prev = nullptr;
+                curr->sibling = nullptr;
+                if (pred(curr->elt)) {
+                    taken.push_back(curr);
+                } else {
+                    rest.push_back(curr);
+                }
+                curr = sibling;
             }
+        }
+        instrument.recordRootChildren(rest.size());
+        root = pairTrees(rest);
+        numNodes -= taken.size();
+
+        std::sort(taken.begin(), taken.end(),
+                  [this](const Node *a, const Node *b) { return lowerPriority(b->elt, a->elt); });
+        for (Node *node : taken) {
+            *out = std::move(node->elt);
+            ++out;
+            deleteNode(node);
+        }
+        return out;
+    }
 
-            // 2) Reset pointers & meld with root
-            node->parent  = nullptr;
-            node->prev    = nullptr;
-            node->sibling = nullptr;
+    // Pop every element more extreme than 'threshold' into 'out', most
+    // extreme first.
+    template<typename OutputIterator>
+    OutputIterator pop_above(const TYPE &threshold, OutputIterator out) {
+        return drain_while([this, &threshold](const TYPE &val) { return lowerPriority(threshold, val); }, out);
+    }
 
+    // Record that the element in 'node' may have changed priority in either
+    // direction (e.g. through a pointer it holds), for the next
+    // updateDirty().
+    void markDirty(Node *node) {
+        if (node) dirtyNodes.push_back(node);
+    }
+
+    // Repair the heap after changes to the nodes marked dirty: each one is
+    // taken out (its children paired back in) and melded back in on its
+    // own, so only the dirty nodes are touched. Falls back to
+    // updatePriorities() when most of the heap is dirty.
+    // Note: Nothing else may be done to the PQ between marking and calling
+    // updateDirty(); in particular a marked node must not be popped.
+    void updateDirty() {
+        if (dirtyNodes.empty()) return;
+        std::sort(dirtyNodes.begin(), dirtyNodes.end());
+        dirtyNodes.erase(std::unique(dirtyNodes.begin(), dirtyNodes.end()), dirtyNodes.end());
+        if (dirtyNodes.size() >= numNodes / 2) {
+            updatePriorities();
+            return;
+        }
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+
+        for (Node *node : dirtyNodes) {
+            if (node == root) {
+                root = mergeChildren(node);
+            } else {
+                cut(node);
+                root = meld(root, mergeChildren(node));
+            }
             root = meld(root, node);
         }
+        dirtyNodes.clear();
     }
 
     // Rebuild entire PQ after changes
     void updatePriorities() {
+        dirtyNodes.clear();
         if (!root) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
 
         // 1) Collect all nodes in a container
         std::deque<Node*> allNodes;
@@ -205,29 +343,171 @@ public:
 
     // Return a pointer to the newly added node, for use with updateElt
     Node *addNode(const TYPE &val) {
-        Node *newNode = new Node(val);
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        Node *newNode = allocateNode(val);
+        instrument.countAllocation();
         root = meld(root, newNode);
         ++numNodes;
         return newNode;
     }
 
+    // Write the heap to a snapshot file at 'path' (see PQSnapshot.hpp):
+    // elements in preorder plus one shape byte per node, so load() can
+    // relink the same tree without comparing anything. TYPE must be
+    // trivially copyable. Throws std::runtime_error if the file can't be
+    // written.
+    void save(const std::string &path) const {
+        std::vector<TYPE> elements;
+        std::vector<unsigned char> shape;
+        elements.reserve(numNodes);
+        shape.reserve(numNodes);
+
+        // Preorder of the child/sibling binary tree: a node, its children,
+        // then its next sibling.
+        std::vector<const Node*> pending;  // Siblings still to be visited
+        for (const Node *curr = root; curr; ) {
+            elements.push_back(curr->elt);
+            shape.push_back(static_cast<unsigned char>((curr->child ? kSnapshotHasChild : 0)
+                                                       | (curr->sibling ? kSnapshotHasSibling : 0)));
+            if (curr->child) {
+                if (curr->sibling) pending.push_back(curr->sibling);
+                curr = curr->child;
+            } else if (curr->sibling) {
+                curr = curr->sibling;
+            } else if (!pending.empty()) {
+                curr = pending.back();
+                pending.pop_back();
+            } else {
+                curr = nullptr;
+            }
+        }
+
+        writeSnapshot(path, SnapshotKind::Pairing, elements.data(), elements.size(), shape.data());
+    }
+
+    // Replace the contents of the PQ with a snapshot. A snapshot written by
+    // PairingPQ::save() (with the same COMP_FUNCTOR) is relinked in O(n);
+    // an array snapshot from one of the vector-backed PQs is pushed element
+    // by element. Throws std::runtime_error if the snapshot is unreadable or
+    // corrupt, leaving the PQ empty.
+    void load(const std::string &path) {
+        dirtyNodes.clear();
+        clear(root);
+        root = nullptr;
+        numNodes = 0;
+
+        std::vector<TYPE> elements;
+        std::vector<unsigned char> shape;
+        if (readSnapshot(path, elements, shape) != SnapshotKind::Pairing) {
+            for (const TYPE &val : elements) {
+                push(val);
+            }
+            return;
+        }
+
+        // The next node becomes parentOfNext's first child if that is set,
+        // else prevOfNext's next sibling; 'pending' holds nodes whose next
+        // sibling follows their children.
+        std::vector<Node*> pending;
+        Node *parentOfNext = nullptr;
+        Node *prevOfNext = nullptr;
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+            Node *node = allocateNode(elements[i]);
+            instrument.countAllocation();
+            if (parentOfNext) {
+                parentOfNext->child = node;
+                node->parent = parentOfNext;
+            } else if (prevOfNext) {
+                prevOfNext->sibling = node;
+                node->prev = prevOfNext;
+                node->parent = prevOfNext->parent;
+            } else if (!root) {
+                root = node;
+            } else {
+                deleteNode(node);
+                failLoad(path);
+            }
+            ++numNodes;
+
+            parentOfNext = nullptr;
+            prevOfNext = nullptr;
+            if (shape[i] & kSnapshotHasChild) {
+                if (shape[i] & kSnapshotHasSibling) pending.push_back(node);
+                parentOfNext = node;
+            } else if (shape[i] & kSnapshotHasSibling) {
+                prevOfNext = node;
+            } else if (!pending.empty()) {
+                prevOfNext = pending.back();
+                pending.pop_back();
+            }
+        }
+
+        if (parentOfNext || prevOfNext || (root && root->sibling)) {
+            failLoad(path);
+        }
+    }
+
+    // Access the instrumentation policy, e.g. to dump() or reset() a
+    // CountingInstrument.
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+    // Return a copy of the node allocator, as an ALLOC.
+    ALLOC get_allocator() const { return ALLOC(nodeAllocator); }
+
 private:
+    using NodeAllocator = typename std::allocator_traits<ALLOC>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+
     Node *root;         // The root of the pairing heap
     std::size_t numNodes;
 
+    // Nodes marked by markDirty() since the last repair.
+    std::vector<Node*> dirtyNodes;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    NodeAllocator nodeAllocator;
+
+    // Allocate and construct a node holding val.
+    Node *allocateNode(const TYPE &val) {
+        Node *node = NodeTraits::allocate(nodeAllocator, 1);
+        try {
+            NodeTraits::construct(nodeAllocator, node, val);
+        } catch (...) {
+            NodeTraits::deallocate(nodeAllocator, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    // Destroy and free a node made by allocateNode().
+    void deleteNode(Node *node) {
+        NodeTraits::destroy(nodeAllocator, node);
+        NodeTraits::deallocate(nodeAllocator, node, 1);
+    }
+
     // ============================
     // Private helper functions
     // ============================
 
+    // this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }
+
     // Meld two trees, returning the resulting root.
     Node *meld(Node *first, Node *second) {
         if (!first) return second;
         if (!second) return first;
 
         // For a max-heap, if first < second => swap so that first is the bigger root
-        if (this->compare(first->elt, second->elt)) {
+        if (lowerPriority(first->elt, second->elt)) {
             std::swap(first, second);
         }
+        instrument.countMoves(1);
         // Attach `second` as a child of `first`
         // Insert `second` at the head of first->child list
         second->parent = first;
@@ -242,6 +522,64 @@ private:
         return first;
     }
 
+    // Cut 'node' (with its subtree) out of its parent's child list in O(1).
+    // 'node' must not be the root.
+    void cut(Node *node) {
+        Node *parent = node->parent;
+
+        // If we have a previous sibling, fix that
+        if (node->prev) {
+            node->prev->sibling = node->sibling;
+        }
+        // If we have a next sibling, fix that
+        if (node->sibling) {
+            node->sibling->prev = node->prev;
+        }
+        // If this node was the direct child of the parent, update that pointer
+        if (parent && parent->child == node) {
+            parent->child = node->sibling;
+        }
+
+        node->parent  = nullptr;
+        node->prev    = nullptr;
+        node->sibling = nullptr;
+    }
+
+    // Detach all children of 'node' and meld them pairwise into a single
+    // tree, returning its root (nullptr if there were no children).
+    Node *mergeChildren(Node *node) {
+        // Gather the children in a deque
+        std::deque<Node*> childList;
+        Node *curr = node->child;
+        while (curr) {
+            Node *next = curr->sibling;
+            // Detach each child from the node
+            curr->parent = nullptr;
+            curr->prev   = nullptr;
+            curr->sibling = nullptr;
+            childList.push_back(curr);
+            curr = next;
+        }
+        node->child = nullptr;
+        instrument.recordRootChildren(childList.size());
+        return pairTrees(childList);
+    }
+
+    // Meld detached trees pairwise, front to back, until one is left, and
+    // return its root (nullptr if there were none).
+    Node *pairTrees(std::deque<Node*> &trees) {
+        while (trees.size() > 1) {
+            Node *first = trees.front();
+            trees.pop_front();
+            Node *second = trees.front();
+            trees.pop_front();
+
+            trees.push_back(meld(first, second));
+        }
+        // If there's exactly one tree left
+        return trees.empty() ? nullptr : trees.front();
+    }
+
     // Collect all nodes in a DFS manner
     void collectNodes(Node *node, std::deque<Node*> &nodes) {
         if (!node) return;
@@ -258,13 +596,31 @@ private:
         }
     }
 
+    // Discard a partially relinked snapshot whose shape bytes don't describe
+    // a single tree.
+    [[noreturn]] void failLoad(const std::string &path) {
+        clear(root);
+        root = nullptr;
+        numNodes = 0;
+        throw std::runtime_error("PQ snapshot: malformed pairing heap in " + path);
+    }
+
     // Recursively free all nodes
     void clear(Node *node) {
         if (!node) return;
         clear(node->child);
         clear(node->sibling);
-        delete node;
+        deleteNode(node);
     }
 };
 
+namespace pmr {
+
+// PairingPQ whose nodes live in a std::pmr::memory_resource, passed after
+// the comparator: pmr::PairingPQ<int> pq { std::less<int>(), &arena };
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+using PairingPQ = ::PairingPQ<TYPE, COMP_FUNCTOR, INSTRUMENT, std::pmr::polymorphic_allocator<TYPE>>;
+
+}  // namespace pmr
+
 #endif  // PAIRINGPQ_H
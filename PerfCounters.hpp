@@ -0,0 +1,184 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters for the benchmark drivers, read through
+// Linux perf_event_open(2) for the calling thread only.
+//
+// Each counter is opened on its own rather than as one group, so a counter
+// the CPU or hypervisor does not expose just reads as unavailable instead of
+// taking the others down with it. In containers where perf_event_open is
+// blocked (seccomp, perf_event_paranoid) everything reports unavailable and
+// the benchmarks fall back to wall-clock numbers only.
+class PerfCounters {
+public:
+    enum Event : std::size_t {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        DTLBMisses,
+    };  // Event
+
+    static const std::size_t kNumEvents = 6;
+
+    // A snapshot of every counter between one start() and stop().
+    struct Reading {
+        std::array<double, kNumEvents> values {};
+        std::array<bool, kNumEvents> valid {};
+    };  // Reading
+
+    PerfCounters() {
+        fds.fill(-1);
+#ifdef __linux__
+        for (std::size_t i = 0; i < kNumEvents; ++i) {
+            fds[i] = open(static_cast<Event>(i));
+        }  // for ..i
+#endif
+    }  // PerfCounters()
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }  // for ..fd
+#endif
+    }  // ~PerfCounters()
+
+    // Description: Return true if at least one counter could be opened.
+    [[nodiscard]] bool available() const {
+        for (int fd : fds) {
+            if (fd >= 0) return true;
+        }  // for ..fd
+        return false;
+    }  // available()
+
+    // Description: Return true if the given counter could be opened.
+    [[nodiscard]] bool available(Event event) const { return fds[event] >= 0; }
+
+    // Description: Zero and enable every open counter.
+    void start() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }  // for ..fd
+#endif
+    }  // start()
+
+    // Description: Disable every open counter and return their values,
+    //              scaled up if the kernel had to multiplex them.
+    Reading stop() {
+        Reading reading;
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }  // for ..fd
+
+        for (std::size_t i = 0; i < kNumEvents; ++i) {
+            if (fds[i] < 0) continue;
+
+            // Layout given by PERF_FORMAT_TOTAL_TIME_ENABLED | ..._RUNNING
+            std::uint64_t raw[3] = { 0, 0, 0 };
+            if (read(fds[i], raw, sizeof(raw)) != static_cast<ssize_t>(sizeof(raw))) continue;
+            if (raw[2] == 0) continue;  // never scheduled onto the PMU
+
+            reading.values[i] = static_cast<double>(raw[0])
+                * (static_cast<double>(raw[1]) / static_cast<double>(raw[2]));
+            reading.valid[i] = true;
+        }  // for ..i
+#endif
+        return reading;
+    }  // stop()
+
+    static const char *name(Event event) {
+        switch (event) {
+        case Cycles:
+            return "cycles";
+        case Instructions:
+            return "instructions";
+        case L1DMisses:
+            return "L1d-misses";
+        case LLCMisses:
+            return "LLC-misses";
+        case BranchMisses:
+            return "branch-misses";
+        case DTLBMisses:
+            return "dTLB-misses";
+        }  // switch
+
+        return "unknown";
+    }  // name()
+
+private:
+    std::array<int, kNumEvents> fds {};
+
+#ifdef __linux__
+    static std::uint64_t cacheConfig(std::uint64_t cache, std::uint64_t op, std::uint64_t result) {
+        return cache | (op << 8) | (result << 16);
+    }  // cacheConfig()
+
+    static int open(Event event) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        switch (event) {
+        case Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case L1DMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                      PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case LLCMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case DTLBMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                      PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        }  // switch
+
+        // pid 0, cpu -1: this thread, on whatever CPU it runs on.
+        const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        return fd < 0 ? -1 : static_cast<int>(fd);
+    }  // open()
+#endif
+};  // PerfCounters
+
+#endif  // PERFCOUNTERS_H
@@ -0,0 +1,235 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef PERSISTENTPQ_H
+#define PERSISTENTPQ_H
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+
+// A persistent (immutable) priority queue implemented as a leftist heap
+// whose nodes are shared between versions.
+//
+// Nodes are never modified once built. push() and pop() copy only the
+// O(log n) nodes on the right spine they touch and share everything else
+// with the previous version, so copying a PersistentPQ is O(1) (it shares
+// the root) and every older copy stays valid and unchanged. That makes a
+// copy a cheap snapshot to hand to a reader: nodes are reference counted
+// with std::shared_ptr, so a snapshot may be read on another thread while
+// the producer keeps pushing and popping its own copy.
+//
+// push()/pop() move this object to the new version; pushed()/popped() leave
+// it alone and return the new version instead.
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp).
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+class PersistentPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+    class Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // ============================
+    // Node class
+    // ============================
+    class Node {
+    public:
+        Node(const TYPE &val, NodePtr leftChild, NodePtr rightChild)
+          : elt(val), left(std::move(leftChild)), right(std::move(rightChild)) {
+            // Leftist property: the right spine is the shorter one.
+            if (rankOf(left) < rankOf(right)) std::swap(left, right);
+            rank = rankOf(right) + 1;
+        }
+
+        // Free the subtrees no other version shares without recursing, as
+        // a heap built from sorted input is one long left spine.
+        ~Node() {
+            std::vector<NodePtr> stack;
+            stack.push_back(std::move(left));
+            stack.push_back(std::move(right));
+            while (!stack.empty()) {
+                NodePtr node = std::move(stack.back());
+                stack.pop_back();
+                if (node && node.use_count() == 1) {
+                    // We hold the last reference, so nobody else can see
+                    // the node while its children are taken. use_count()
+                    // is a relaxed load; the fence orders the writes below
+                    // after other threads' reads made before they dropped
+                    // their references.
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    Node &owned = const_cast<Node &>(*node);
+                    stack.push_back(std::move(owned.left));
+                    stack.push_back(std::move(owned.right));
+                }
+            }
+        }
+
+        Node(const Node &) = delete;
+        Node &operator=(const Node &) = delete;
+
+        TYPE elt;
+        NodePtr left;
+        NodePtr right;
+
+        // Length of the right spine (the s-value).
+        std::size_t rank;
+    };
+
+public:
+    // ============================
+    // Constructors
+    // ============================
+    explicit PersistentPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, root(nullptr), numNodes(0) {}
+
+    // Build in O(n) by melding singletons pairwise, round by round.
+    template<typename InputIterator>
+    PersistentPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, root(nullptr), numNodes(0) {
+        std::vector<NodePtr> trees;
+        for (; start != end; ++start) {
+            trees.push_back(makeNode(*start, nullptr, nullptr));
+        }
+        numNodes = trees.size();
+        root = meldAll(trees);
+    }
+
+    // Copies and moves just share or take the root: O(1).
+    PersistentPQ(const PersistentPQ &) = default;
+    PersistentPQ(PersistentPQ &&) noexcept = default;
+    PersistentPQ &operator=(const PersistentPQ &) = default;
+    PersistentPQ &operator=(PersistentPQ &&) noexcept = default;
+    virtual ~PersistentPQ() = default;
+
+    // ============================
+    // Required interface
+    // ============================
+    virtual void push(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        root = meld(root, makeNode(val, nullptr, nullptr));
+        ++numNodes;
+    }
+
+    virtual void pop() {
+        if (!root) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+        instrument.recordRootChildren((root->left ? 1 : 0) + (root->right ? 1 : 0));
+        root = meld(root->left, root->right);
+        --numNodes;
+    }
+
+    virtual const TYPE &top() const {
+        if (!root) {
+            throw std::runtime_error("PersistentPQ: top() called on empty PQ!");
+        }
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
+        return root->elt;
+    }
+
+    [[nodiscard]] virtual std::size_t size() const { return numNodes; }
+    [[nodiscard]] virtual bool empty() const { return (root == nullptr); }
+
+    // Nodes are immutable, so the only way elements can fall out of order is
+    // through data they point to (e.g. a PQ of pointers). Rebuild this
+    // version from its elements in O(n); other versions keep their nodes.
+    virtual void updatePriorities() {
+        if (!root) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+
+        std::vector<NodePtr> trees;
+        trees.reserve(numNodes);
+        std::vector<const Node*> stack { root.get() };
+        while (!stack.empty()) {
+            const Node *curr = stack.back();
+            stack.pop_back();
+            trees.push_back(makeNode(curr->elt, nullptr, nullptr));
+            if (curr->left)  stack.push_back(curr->left.get());
+            if (curr->right) stack.push_back(curr->right.get());
+        }
+        root = meldAll(trees);
+    }
+
+    // ============================
+    // Persistent interface
+    // ============================
+
+    // Return a new version with val added; this version is unchanged.
+    [[nodiscard]] PersistentPQ pushed(const TYPE &val) const {
+        PersistentPQ next(*this);
+        next.push(val);
+        return next;
+    }
+
+    // Return a new version without the most extreme element; this version
+    // is unchanged.
+    [[nodiscard]] PersistentPQ popped() const {
+        PersistentPQ next(*this);
+        next.pop();
+        return next;
+    }
+
+    // Access the instrumentation policy, e.g. to dump() or reset() a
+    // CountingInstrument.
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+private:
+    NodePtr root;       // Root of this version
+    std::size_t numNodes;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // ============================
+    // Private helper functions
+    // ============================
+
+    // this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }
+
+    static std::size_t rankOf(const NodePtr &node) {
+        return node ? node->rank : 0;
+    }
+
+    NodePtr makeNode(const TYPE &val, NodePtr left, NodePtr right) {
+        instrument.countAllocation();
+        return std::make_shared<Node>(val, std::move(left), std::move(right));
+    }
+
+    // Meld two heaps along their right spines, copying the spine nodes and
+    // sharing everything else. Recursion depth is bounded by the two ranks,
+    // which are O(log n).
+    NodePtr meld(const NodePtr &first, const NodePtr &second) {
+        if (!first) return second;
+        if (!second) return first;
+
+        if (lowerPriority(first->elt, second->elt)) {
+            return meld(second, first);
+        }
+        instrument.countMoves(1);
+        return makeNode(first->elt, first->left, meld(first->right, second));
+    }
+
+    // Meld a list of heaps pairwise until one is left.
+    NodePtr meldAll(std::vector<NodePtr> &trees) {
+        if (trees.empty()) return nullptr;
+        while (trees.size() > 1) {
+            std::size_t out = 0;
+            for (std::size_t i = 0; i + 1 < trees.size(); i += 2) {
+                trees[out++] = meld(trees[i], trees[i + 1]);
+            }
+            if (trees.size() % 2 == 1) trees[out++] = std::move(trees.back());
+            trees.resize(out);
+        }
+        return trees.front();
+    }
+};
+
+#endif  // PERSISTENTPQ_H
@@ -0,0 +1,262 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef PRIORITYEXECUTOR_H
+#define PRIORITYEXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+
+// A fixed pool of worker threads that runs callables in priority order.
+//
+// Every worker owns a queue, a PQ<Task, TaskLess> behind its own mutex, so
+// the PQ engine is a template argument: BinaryPQ, PairingPQ,
+// CompactPairingPQ, or anything else with the Eecs281PQ interface. A worker
+// runs the most urgent task in its own queue; when that is empty it steals
+// the best half of another worker's queue, so urgent work spreads out
+// instead of waiting behind one busy worker.
+//
+// Tasks posted from outside the pool are dealt to the workers round-robin;
+// tasks posted by a running task go to its own worker's queue. Higher
+// priority values run first, and tasks of equal priority on one queue run
+// in the order they were posted. Priority order is per queue, not global:
+// with N workers up to N tasks run at once, and a worker finishes the task
+// it started before looking at newer, more urgent ones.
+template<template<typename...> typename PQ = BinaryPQ>
+class PriorityExecutor {
+public:
+    // Description: Start 'threads' workers (at least one).
+    // Runtime: O(threads)
+    explicit PriorityExecutor(std::size_t threads = std::thread::hardware_concurrency()) {
+        if (threads == 0) threads = 1;
+        for (std::size_t i = 0; i < threads; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }  // for ..i
+        workers.reserve(threads);
+        try {
+            for (std::size_t i = 0; i < threads; ++i) {
+                workers.emplace_back([this, i] { workerLoop(i); });
+            }  // for ..i
+        } catch (...) {
+            // The destructor won't run, and a joinable std::thread that is
+            // destroyed calls std::terminate.
+            stopWorkers();
+            throw;
+        }  // try
+    }  // PriorityExecutor()
+
+
+    PriorityExecutor(const PriorityExecutor &) = delete;
+    PriorityExecutor &operator=(const PriorityExecutor &) = delete;
+
+
+    // Description: Run every task still queued, then stop the workers.
+    // Runtime: O(queued tasks)
+    ~PriorityExecutor() { stopWorkers(); }
+
+
+    // Description: Queue fn() to run with the given priority. fn must not
+    //              throw; use submit() for work that can fail.
+    // Runtime: O(log(n)) with BinaryPQ, plus a lock
+    template<typename FUNCTION>
+    void post(int priority, FUNCTION &&fn) {
+        Task task { priority, nextSeq.fetch_add(1, std::memory_order_relaxed),
+                    std::function<void()>(std::forward<FUNCTION>(fn)) };
+        unfinished.fetch_add(1, std::memory_order_relaxed);
+
+        std::size_t target = 0;
+        if (currentExecutor == this) {
+            target = currentWorker;
+        } else {
+            target = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        }  // if
+        WorkerQueue &queue = *queues[target];
+        {
+            std::lock_guard<std::mutex> lock { queue.mutex };
+            queue.pq.push(task);
+            queued.fetch_add(1, std::memory_order_release);
+        }
+
+        // Taking the lock orders this notify after a sleeper's last check.
+        { std::lock_guard<std::mutex> lock { sleepMutex }; }
+        wakeup.notify_one();
+    }  // post()
+
+
+    // Description: Queue fn() to run with the given priority and return a
+    //              future for its result; an exception fn throws is stored
+    //              in the future.
+    // Runtime: as post(), plus allocating the shared state
+    template<typename FUNCTION>
+    auto submit(int priority, FUNCTION &&fn)
+        -> std::future<std::invoke_result_t<std::decay_t<FUNCTION>>> {
+        using Result = std::invoke_result_t<std::decay_t<FUNCTION>>;
+        auto job = std::make_shared<std::packaged_task<Result()>>(std::forward<FUNCTION>(fn));
+        std::future<Result> result = job->get_future();
+        post(priority, [job] { (*job)(); });
+        return result;
+    }  // submit()
+
+
+    // Description: Block until every task posted so far, and every task
+    //              those post in turn, has finished. Must not be called from
+    //              a task.
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock { sleepMutex };
+        idle.wait(lock, [this] { return unfinished.load(std::memory_order_acquire) == 0; });
+    }  // waitIdle()
+
+
+    [[nodiscard]] std::size_t threadCount() const { return workers.size(); }
+
+    // Number of steals so far (each takes half of one victim's queue).
+    [[nodiscard]] std::uint64_t stealCount() const {
+        return steals.load(std::memory_order_relaxed);
+    }  // stealCount()
+
+private:
+    struct Task {
+        int priority = 0;
+        std::uint64_t seq = 0;
+        std::function<void()> fn;
+    };  // Task
+
+    // Higher priority first; among equal priorities, first posted first.
+    struct TaskLess {
+        bool operator()(const Task &a, const Task &b) const {
+            if (a.priority != b.priority) return a.priority < b.priority;
+            return a.seq > b.seq;
+        }  // operator()()
+    };  // TaskLess
+
+    // One worker's queue, on its own cache line so that workers locking
+    // neighbouring queues don't slow each other down.
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        PQ<Task, TaskLess> pq;
+    };  // WorkerQueue
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<std::uint64_t> nextSeq { 0 };
+    std::atomic<std::size_t> nextQueue { 0 };
+    std::atomic<std::size_t> queued { 0 };      // tasks sitting in queues
+    std::atomic<std::size_t> unfinished { 0 };  // posted and not yet finished
+    std::atomic<std::uint64_t> steals { 0 };
+
+    // Guards sleeping and stopping; idle workers wait on 'wakeup' and
+    // waitIdle() waits on 'idle'.
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    std::condition_variable idle;
+    bool stopping = false;
+
+    // Which executor and worker the current thread belongs to, so post()
+    // from inside a task can use the local queue.
+    static inline thread_local PriorityExecutor *currentExecutor = nullptr;
+    static inline thread_local std::size_t currentWorker = 0;
+
+
+    void workerLoop(std::size_t index) {
+        currentExecutor = this;
+        currentWorker = index;
+
+        Task task;
+        while (true) {
+            if (popLocal(index, task) || steal(index, task)) {
+                run(task);
+                continue;
+            }  // if
+
+            std::unique_lock<std::mutex> lock { sleepMutex };
+            wakeup.wait(lock, [this] {
+                return stopping || queued.load(std::memory_order_acquire) > 0;
+            });
+            if (stopping && queued.load(std::memory_order_acquire) == 0) return;
+        }  // while
+    }  // workerLoop()
+
+
+    // Description: Let the workers drain every queue and exit, and join
+    //              each one that was started.
+    void stopWorkers() {
+        {
+            std::lock_guard<std::mutex> lock { sleepMutex };
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }  // for ..worker
+    }  // stopWorkers()
+
+
+    // Description: Take the most urgent task from queue 'index'.
+    bool popLocal(std::size_t index, Task &task) {
+        WorkerQueue &queue = *queues[index];
+        std::lock_guard<std::mutex> lock { queue.mutex };
+        if (queue.pq.empty()) return false;
+
+        task = queue.pq.top();
+        queue.pq.pop();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }  // popLocal()
+
+
+    // Description: Take the best half (rounded up) of the first non-empty
+    //              queue after 'thief', keep the most urgent of those in
+    //              'task' and move the rest to the thief's own queue.
+    //              Only one queue is locked at a time.
+    bool steal(std::size_t thief, Task &task) {
+        std::vector<Task> loot;
+        for (std::size_t offset = 1; offset < queues.size() && loot.empty(); ++offset) {
+            WorkerQueue &victim = *queues[(thief + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock { victim.mutex };
+            const std::size_t count = (victim.pq.size() + 1) / 2;
+            loot.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                loot.push_back(victim.pq.top());
+                victim.pq.pop();
+            }  // for ..i
+        }  // for ..offset
+        if (loot.empty()) return false;
+        steals.fetch_add(1, std::memory_order_relaxed);
+
+        // loot came out most urgent first.
+        task = std::move(loot.front());
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        if (loot.size() > 1) {
+            WorkerQueue &own = *queues[thief];
+            std::lock_guard<std::mutex> lock { own.mutex };
+            for (std::size_t i = 1; i < loot.size(); ++i) {
+                own.pq.push(loot[i]);
+            }  // for ..i
+        }  // if
+        return true;
+    }  // steal()
+
+
+    void run(Task &task) {
+        task.fn();
+        task.fn = nullptr;
+        if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            { std::lock_guard<std::mutex> lock { sleepMutex }; }
+            idle.notify_all();
+        }  // if
+    }  // run()
+};  // PriorityExecutor
+
+#endif  // PRIORITYEXECUTOR_H
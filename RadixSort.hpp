@@ -0,0 +1,192 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// An LSD radix sort for containers whose comparator orders elements by an
+// arithmetic key with std::less or std::greater: each element's key is
+// encoded as an unsigned integer whose order matches the comparator's, and
+// the elements are distributed by one byte of it per pass, least
+// significant first. That is O(n) per byte of key, with no comparisons.
+//
+// RadixKey<TYPE, COMP_FUNCTOR>::enabled says whether COMP_FUNCTOR can be
+// sorted this way. It is for
+// - std::less<T> / std::greater<T> (or std::less<> / std::greater<>) on an
+//   arithmetic T of at most 8 bytes (float and double only if IEEE 754);
+// - KeyCompare<KEY_OF, ORDER> where KEY_OF extracts such a key from TYPE
+//   and ORDER is one of those orders:
+//       struct JobCost { int operator()(const Job &job) const { return job.cost; } };
+//       SortedPQ<Job, KeyCompare<JobCost>> pq;
+//
+// Floats are encoded by flipping the sign bit of non-negative values and
+// every bit of negative ones, so -0.0 sorts just before +0.0 (equivalent
+// under std::less, so either order is sorted) and NaNs sort to the ends.
+
+// Compare elements by ORDER on the keys that KEY_OF extracts from them.
+template<typename KEY_OF, typename ORDER = std::less<>>
+struct KeyCompare {
+    KEY_OF keyOf;
+    ORDER order;
+
+    template<typename TYPE>
+    bool operator()(const TYPE &a, const TYPE &b) const {
+        return order(keyOf(a), keyOf(b));
+    }  // operator()()
+};  // KeyCompare
+
+
+namespace radix_detail {
+
+template<typename KEY>
+constexpr bool encodable = std::is_arithmetic_v<KEY> && sizeof(KEY) <= 8
+                           && (std::is_integral_v<KEY> || std::numeric_limits<KEY>::is_iec559);
+
+template<std::size_t BYTES> struct UnsignedOfSize;
+template<> struct UnsignedOfSize<1> { using type = std::uint8_t; };
+template<> struct UnsignedOfSize<2> { using type = std::uint16_t; };
+template<> struct UnsignedOfSize<4> { using type = std::uint32_t; };
+template<> struct UnsignedOfSize<8> { using type = std::uint64_t; };
+
+template<typename KEY>
+using Encoded = typename UnsignedOfSize<sizeof(KEY)>::type;
+
+// +1 if ORDER sorts KEYs ascending (std::less), -1 if descending
+// (std::greater), 0 if it is anything else.
+template<typename ORDER, typename KEY> constexpr int direction = 0;
+template<typename KEY> constexpr int direction<std::less<KEY>, KEY> = 1;
+template<typename KEY> constexpr int direction<std::less<>, KEY> = 1;
+template<typename KEY> constexpr int direction<std::greater<KEY>, KEY> = -1;
+template<typename KEY> constexpr int direction<std::greater<>, KEY> = -1;
+
+// Description: An unsigned integer that orders like 'key' under ORDER.
+template<int DIRECTION, typename KEY>
+Encoded<KEY> encode(KEY key) {
+    using U = Encoded<KEY>;
+    constexpr U signBit = static_cast<U>(U { 1 } << (8 * sizeof(KEY) - 1));
+    U bits;
+    if constexpr (std::is_floating_point_v<KEY>) {
+        std::memcpy(&bits, &key, sizeof(KEY));
+        bits = (bits & signBit) ? static_cast<U>(~bits) : static_cast<U>(bits | signBit);
+    } else if constexpr (std::is_signed_v<KEY>) {
+        bits = static_cast<U>(static_cast<U>(key) ^ signBit);
+    } else {
+        bits = static_cast<U>(key);
+    }  // if
+    return DIRECTION > 0 ? bits : static_cast<U>(~bits);
+}  // encode()
+
+}  // namespace radix_detail
+
+
+// The comparator itself compares arithmetic TYPEs.
+template<typename TYPE, typename COMP_FUNCTOR>
+struct RadixKey {
+    static constexpr bool enabled = radix_detail::encodable<TYPE>
+                                    && radix_detail::direction<COMP_FUNCTOR, TYPE> != 0;
+
+    static auto key(const COMP_FUNCTOR &, const TYPE &val) {
+        return radix_detail::encode<radix_detail::direction<COMP_FUNCTOR, TYPE>>(val);
+    }  // key()
+};  // RadixKey
+
+
+// The comparator extracts a key from each TYPE.
+template<typename TYPE, typename KEY_OF, typename ORDER>
+struct RadixKey<TYPE, KeyCompare<KEY_OF, ORDER>> {
+    using Key = std::decay_t<std::invoke_result_t<const KEY_OF &, const TYPE &>>;
+
+    static constexpr bool enabled = radix_detail::encodable<Key> && radix_detail::direction<ORDER, Key> != 0;
+
+    static auto key(const KeyCompare<KEY_OF, ORDER> &comp, const TYPE &val) {
+        return radix_detail::encode<radix_detail::direction<ORDER, Key>>(static_cast<Key>(comp.keyOf(val)));
+    }  // key()
+};  // RadixKey
+
+
+// Below about this many elements std::sort is faster: every pass pays for
+// a 256-bucket prefix sum that small inputs don't amortize.
+template<typename TYPE, typename COMP_FUNCTOR>
+constexpr std::size_t radixSortCutoff
+    = 256 * sizeof(decltype(RadixKey<TYPE, COMP_FUNCTOR>::key(std::declval<const COMP_FUNCTOR &>(),
+                                                              std::declval<const TYPE &>())));
+
+
+// A scratch vector that a container keeps between radixSort() calls, so
+// that repeated sorts don't allocate. Copies start out empty: there is no
+// point copying scratch space.
+template<typename TYPE, typename ALLOC = std::allocator<TYPE>>
+class RadixScratch {
+public:
+    explicit RadixScratch(const ALLOC &alloc = ALLOC()) : buffer(alloc) {}
+
+    RadixScratch(const RadixScratch &other)
+        : buffer(std::allocator_traits<ALLOC>::select_on_container_copy_construction(other.buffer.get_allocator())) {}
+    RadixScratch(RadixScratch &&) noexcept = default;
+    RadixScratch &operator=(const RadixScratch &) { return *this; }
+    RadixScratch &operator=(RadixScratch &&) noexcept = default;
+
+    std::vector<TYPE, ALLOC> buffer;
+};  // RadixScratch
+
+
+// Description: Sort 'data' into ascending order under 'comp', for which
+//              RadixKey<TYPE, COMP_FUNCTOR>::enabled must be true, using
+//              'scratch' (resized to data.size()) as the second buffer.
+//              TYPE must be default constructible and copyable; the sort is
+//              stable. Passes whose byte is the same in every key are
+//              skipped, so small or clustered keys cost fewer passes.
+// Runtime: O(n) per byte of key
+template<typename TYPE, typename COMP_FUNCTOR, typename ALLOC>
+void radixSort(std::vector<TYPE, ALLOC> &data, std::vector<TYPE, ALLOC> &scratch, const COMP_FUNCTOR &comp) {
+    using Key = RadixKey<TYPE, COMP_FUNCTOR>;
+    static_assert(Key::enabled, "radixSort: COMP_FUNCTOR doesn't order TYPE by an arithmetic key");
+    using U = decltype(Key::key(comp, data.front()));
+    constexpr std::size_t kPasses = sizeof(U);
+
+    const std::size_t n = data.size();
+    if (n < 2) return;
+
+    // Every pass's byte histogram, from one read of the keys.
+    std::array<std::array<std::size_t, 256>, kPasses> counts {};
+    for (const TYPE &val : data) {
+        const U key = Key::key(comp, val);
+        for (std::size_t pass = 0; pass < kPasses; ++pass) {
+            ++counts[pass][(key >> (8 * pass)) & 0xFF];
+        }  // for ..pass
+    }  // for ..val
+
+    scratch.resize(n);
+    std::vector<TYPE, ALLOC> *from = &data;
+    std::vector<TYPE, ALLOC> *to = &scratch;
+    const U firstKey = Key::key(comp, data.front());
+    for (std::size_t pass = 0; pass < kPasses; ++pass) {
+        const std::size_t shift = 8 * pass;
+        std::array<std::size_t, 256> &count = counts[pass];
+        if (count[(firstKey >> shift) & 0xFF] == n) continue;
+
+        std::size_t offset = 0;
+        for (std::size_t &bucket : count) {
+            offset += std::exchange(bucket, offset);
+        }  // for ..bucket
+        for (TYPE &val : *from) {
+            (*to)[count[(Key::key(comp, val) >> shift) & 0xFF]++] = std::move(val);
+        }  // for ..val
+        std::swap(from, to);
+    }  // for ..pass
+
+    if (from != &data) std::move(scratch.begin(), scratch.end(), data.begin());
+}  // radixSort()
+
+#endif  // RADIXSORT_H
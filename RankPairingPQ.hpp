@@ -0,0 +1,329 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef RANKPAIRINGPQ_H
+#define RANKPAIRINGPQ_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+
+// A specialized version of the priority queue ADT implemented as a type-1
+// rank-pairing heap (Haeupler, Sen and Tarjan, 2011).
+//
+// It exposes the same Node* handle API as PairingPQ (addNode, updateElt,
+// Node::getElt), so the two can be swapped with a template argument. Unlike
+// the pairing heap, updateElt is provably O(1) amortized: the node is cut
+// into its own half-tree and ranks are repaired along a path of amortized
+// constant length. pop() then links half-trees only with others of equal
+// rank, which bounds the work a storm of updateElt calls can leave behind.
+//
+// The heap is a list of half-ordered half-trees kept in binary form: each
+// node's left child starts its list of children and its right child is its
+// next sibling. A root has no right child; its 'right' field links the list
+// of roots instead.
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp).
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+class RankPairingPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // ============================
+    // Node class
+    // ============================
+    class Node {
+    public:
+        explicit Node(const TYPE &val)
+          : elt(val), left(nullptr), right(nullptr), parent(nullptr), rank(0) {}
+
+        const TYPE &getElt() const { return elt; }
+        const TYPE &operator*() const { return elt; }
+
+        friend RankPairingPQ;  // So the outer class can access private fields
+    private:
+        TYPE elt;
+
+        // First child (in binary form).
+        Node *left;
+
+        // Next sibling, or for a root the next root in the root list.
+        Node *right;
+
+        // Binary-tree parent; nullptr for roots.
+        Node *parent;
+
+        // Rank as defined by the type-1 rank rule.
+        int rank;
+    };
+
+    // ============================
+    // Constructors, destructor
+    // ============================
+    explicit RankPairingPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, roots(nullptr), best(nullptr), numNodes(0) {}
+
+    template<typename InputIterator>
+    RankPairingPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+      : BaseClass{comp}, roots(nullptr), best(nullptr), numNodes(0) {
+        for (; start != end; ++start) {
+            push(*start);
+        }
+    }
+
+    // Copy constructor
+    RankPairingPQ(const RankPairingPQ &other)
+      : BaseClass{other.compare}, roots(nullptr), best(nullptr), numNodes(0) {
+        for (Node *node : other.collectNodes()) {
+            push(node->elt);
+        }
+    }
+
+    // Copy-assignment operator
+    RankPairingPQ &operator=(const RankPairingPQ &rhs) {
+        if (this != &rhs) {
+            RankPairingPQ temp(rhs);
+            std::swap(roots, temp.roots);
+            std::swap(best, temp.best);
+            std::swap(numNodes, temp.numNodes);
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~RankPairingPQ() {
+        for (Node *node : collectNodes()) {
+            delete node;
+        }
+    }
+
+    // ============================
+    // Required interface
+    // ============================
+    virtual void push(const TYPE &val) {
+        addNode(val);
+    }
+
+    // Remove the best root, split its left spine into half-trees and link
+    // them with the other roots in one pass of rank-wise pairing.
+    virtual void pop() {
+        if (!best) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+
+        halfTrees.clear();
+        for (Node *root = roots; root; root = root->right) {
+            if (root != best) halfTrees.push_back(root);
+        }
+        for (Node *spine = best->left; spine; ) {
+            Node *next = spine->right;
+            spine->right = nullptr;
+            spine->parent = nullptr;
+            spine->rank = rankOf(spine->left) + 1;
+            halfTrees.push_back(spine);
+            spine = next;
+        }
+        instrument.recordRootChildren(halfTrees.size());
+
+        delete best;
+        --numNodes;
+        roots = nullptr;
+        best = nullptr;
+
+        // One-pass linking: pair half-trees of equal rank as they are found;
+        // a linked tree goes straight to the new root list.
+        for (Node *tree : halfTrees) {
+            const std::size_t r = static_cast<std::size_t>(tree->rank);
+            if (r >= buckets.size()) buckets.resize(r + 1, nullptr);
+
+            if (!buckets[r]) {
+                buckets[r] = tree;
+            } else {
+                addRoot(link(buckets[r], tree));
+                buckets[r] = nullptr;
+            }
+        }
+        for (Node *&tree : buckets) {
+            if (tree) {
+                addRoot(tree);
+                tree = nullptr;
+            }
+        }
+    }
+
+    virtual const TYPE &top() const {
+        if (!best) {
+            throw std::runtime_error("RankPairingPQ: top() called on empty PQ!");
+        }
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
+        return best->elt;
+    }
+
+    [[nodiscard]] virtual std::size_t size() const { return numNodes; }
+    [[nodiscard]] virtual bool empty() const { return (best == nullptr); }
+
+    // ============================
+    // Rank-pairing-heap-specific interface
+    // ============================
+
+    // Make 'node' more extreme. Like PairingPQ::updateElt, a new_value that
+    // is not more extreme than the current one is ignored.
+    void updateElt(Node *node, const TYPE &new_value) {
+        if (!node) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdateElt };
+
+        if (!lowerPriority(node->elt, new_value)) {
+            return;
+        }
+        node->elt = new_value;
+
+        if (node->parent) {
+            // Cut 'node' and its left subtree into a half-tree of its own;
+            // its right subtree (its younger siblings) takes its place.
+            Node *parent = node->parent;
+            Node *replacement = node->right;
+            if (parent->left == node) {
+                parent->left = replacement;
+            } else {
+                parent->right = replacement;
+            }
+            if (replacement) replacement->parent = parent;
+
+            node->parent = nullptr;
+            node->rank = rankOf(node->left) + 1;
+            addRoot(node);
+
+            repairRanks(parent);
+        } else if (node != best && lowerPriority(best->elt, node->elt)) {
+            best = node;
+        }
+    }
+
+    // Rebuild the entire PQ after arbitrary changes: every node becomes a
+    // one-node half-tree, and the next pop() links them.
+    void updatePriorities() {
+        if (!best) return;
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+
+        const std::vector<Node*> allNodes = collectNodes();
+        roots = nullptr;
+        best = nullptr;
+        for (Node *node : allNodes) {
+            node->left = nullptr;
+            node->right = nullptr;
+            node->parent = nullptr;
+            node->rank = 0;
+            addRoot(node);
+        }
+    }
+
+    // Return a pointer to the newly added node, for use with updateElt
+    Node *addNode(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        Node *newNode = new Node(val);
+        instrument.countAllocation();
+        addRoot(newNode);
+        ++numNodes;
+        return newNode;
+    }
+
+    // Access the instrumentation policy, e.g. to dump() or reset() a
+    // CountingInstrument.
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+private:
+    Node *roots;        // Head of the root list, linked through 'right'
+    Node *best;         // The most extreme root
+    std::size_t numNodes;
+
+    // Scratch space reused by every pop() so it does not allocate.
+    std::vector<Node*> halfTrees;
+    std::vector<Node*> buckets;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // ============================
+    // Private helper functions
+    // ============================
+
+    // this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }
+
+    static int rankOf(const Node *node) {
+        return node ? node->rank : -1;
+    }
+
+    // Put a half-tree on the root list and update 'best'.
+    void addRoot(Node *node) {
+        node->right = roots;
+        roots = node;
+        if (!best || lowerPriority(best->elt, node->elt)) {
+            best = node;
+        }
+    }
+
+    // Link two half-trees of equal rank: the loser becomes the winner's
+    // first child, and the winner's rank goes up by one.
+    Node *link(Node *first, Node *second) {
+        if (lowerPriority(first->elt, second->elt)) {
+            std::swap(first, second);
+        }
+        second->right = first->left;
+        if (second->right) second->right->parent = second;
+        second->parent = first;
+        first->left = second;
+        first->right = nullptr;
+        first->rank = second->rank + 1;
+        instrument.countMoves(1);
+        return first;
+    }
+
+    // After a cut below 'node', walk up restoring the type-1 rank rule
+    // (a node's rank is its larger child rank if they differ, one more
+    // than the common child rank if they are equal) until a rank stops
+    // decreasing or a root is reached.
+    void repairRanks(Node *node) {
+        while (node) {
+            if (!node->parent) {
+                node->rank = rankOf(node->left) + 1;
+                return;
+            }
+
+            const int leftRank = rankOf(node->left);
+            const int rightRank = rankOf(node->right);
+            const int rank = leftRank == rightRank ? leftRank + 1 : std::max(leftRank, rightRank);
+            if (rank >= node->rank) return;
+
+            node->rank = rank;
+            node = node->parent;
+        }
+    }
+
+    // Collect every node, walking each half-tree from the root list.
+    std::vector<Node*> collectNodes() const {
+        std::vector<Node*> nodes;
+        nodes.reserve(numNodes);
+        std::vector<Node*> stack;
+        for (Node *root = roots; root; root = root->right) {
+            nodes.push_back(root);
+            if (root->left) stack.push_back(root->left);
+
+            while (!stack.empty()) {
+                Node *curr = stack.back();
+                stack.pop_back();
+
+                nodes.push_back(curr);
+                if (curr->left)  stack.push_back(curr->left);
+                if (curr->right) stack.push_back(curr->right);
+            }
+        }
+        return nodes;
+    }
+};
+
+#endif  // RANKPAIRINGPQ_H
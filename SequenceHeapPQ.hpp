@@ -0,0 +1,307 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef SEQUENCEHEAPPQ_H
+#define SEQUENCEHEAPPQ_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "Eecs281PQ.hpp"
+#include "LoserTree.hpp"
+#include "PQInstrument.hpp"
+
+// A cache-efficient priority queue for very large queues, after Sanders'
+// sequence heap. A BinaryPQ of 10^8 elements misses the cache on nearly
+// every level of every sift; here almost all the data lives in sorted
+// sequences that are only ever read or written front to back.
+//
+// - New elements go into a small insertion heap (kInsertCapacity elements,
+//   so it stays in L1/L2).
+// - When the insertion heap is full it is sorted into a sequence and added
+//   to group 0. Once a group holds kMergeWays sequences they are merged,
+//   with a LoserTree, into one sequence of the next group, so an element
+//   takes part in O(log(n) / log(kMergeWays)) sequential merges in all.
+// - A deletion buffer in front holds the most extreme elements of all the
+//   sequences, refilled kBufferSize at a time by one k-way merge over
+//   their fronts. Every element in it is at least as extreme as every
+//   element left in the sequences, so top() is the better of the buffer's
+//   best and the insertion heap's top.
+//
+// Sequences are stored most extreme first and consumed from the front; the
+// deletion buffer is stored most extreme last, like SortedPQ.
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp).
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+class SequenceHeapPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
+    // This is a way to refer to the base class object.
+    using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
+
+public:
+    // Description: Construct an empty PQ with an optional comparison functor.
+    // Runtime: O(1)
+    explicit SequenceHeapPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : BaseClass { comp } {}
+
+
+    // Description: Construct a PQ out of an iterator range with an optional
+    //              comparison functor.
+    // Runtime: O(n log(n)) where n is number of elements in range.
+    template<typename InputIterator>
+    SequenceHeapPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : BaseClass { comp } {
+        std::vector<TYPE> all(start, end);
+        rebuildFrom(std::move(all));
+    }  // SequenceHeapPQ
+
+
+    // Description: Destructor doesn't need any code, the vectors will be
+    //              destroyed automatically.
+    virtual ~SequenceHeapPQ() = default;
+
+
+    // Description: Copying and moving need no code either.
+    SequenceHeapPQ(const SequenceHeapPQ &) = default;
+    SequenceHeapPQ(SequenceHeapPQ &&) noexcept = default;
+    SequenceHeapPQ &operator=(const SequenceHeapPQ &) = default;
+    SequenceHeapPQ &operator=(SequenceHeapPQ &&) noexcept = default;
+
+
+    // Description: Assumes that all elements inside the PQ are out of order
+    //              and rebuilds it as one sorted sequence.
+    // Runtime: O(n log(n))
+    virtual void updatePriorities() {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+        std::vector<TYPE> all;
+        all.reserve(count);
+        all.insert(all.end(), insertion.begin(), insertion.end());
+        all.insert(all.end(), buffer.begin(), buffer.end());
+        for (std::vector<Sequence> &group : groups) {
+            for (Sequence &sequence : group) {
+                all.insert(all.end(), sequence.remaining(), sequence.elements.cend());
+            }  // for ..sequence
+        }  // for ..group
+        rebuildFrom(std::move(all));
+    }  // updatePriorities()
+
+
+    // Description: Add a new element to the PQ.
+    // Runtime: Amortized O(log(n)), with sequential memory access for all
+    //          but the insertion heap
+    virtual void push(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        if (insertion.size() == kInsertCapacity) flushInsertion();
+        insertion.push_back(val);
+        std::push_heap(insertion.begin(), insertion.end(), Lower { this });
+        ++count;
+    }  // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element
+    //              from the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: Amortized O(log(n))
+    virtual void pop() {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+        if (topIsInBuffer()) {
+            buffer.pop_back();
+            if (buffer.empty()) refillBuffer();
+        } else {
+            std::pop_heap(insertion.begin(), insertion.end(), Lower { this });
+            insertion.pop_back();
+        }  // if
+        --count;
+    }  // pop()
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: O(1)
+    virtual const TYPE &top() const {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
+        return topIsInBuffer() ? buffer.back() : insertion.front();
+    }  // top()
+
+
+    // Description: Get the number of elements in the PQ.
+    // Runtime: O(1)
+    [[nodiscard]] virtual std::size_t size() const { return count; }
+
+
+    // Description: Return true if the PQ is empty.
+    // Runtime: O(1)
+    [[nodiscard]] virtual bool empty() const { return count == 0; }
+
+
+    // Description: Access the instrumentation policy, e.g. to dump() or
+    //              reset() a CountingInstrument.
+    // Runtime: O(1)
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+private:
+    // A sorted sequence, most extreme first, read from 'next' on.
+    struct Sequence {
+        std::vector<TYPE> elements;
+        std::size_t next = 0;
+
+        typename std::vector<TYPE>::const_iterator remaining() const {
+            return elements.begin() + static_cast<std::ptrdiff_t>(next);
+        }  // remaining()
+
+        [[nodiscard]] bool exhausted() const { return next == elements.size(); }
+    };  // Sequence
+
+    // this->compare through lowerPriority(), for the standard algorithms
+    // and the loser tree.
+    struct Lower {
+        const SequenceHeapPQ *pq;
+
+        bool operator()(const TYPE &a, const TYPE &b) const {
+            return pq->lowerPriority(a, b);
+        }  // operator()()
+    };  // Lower
+
+    // The reverse, for sorting most extreme first.
+    struct Higher {
+        const SequenceHeapPQ *pq;
+
+        bool operator()(const TYPE &a, const TYPE &b) const {
+            return pq->lowerPriority(b, a);
+        }  // operator()()
+    };  // Higher
+
+    // Small enough that the insertion heap and deletion buffer stay in
+    // cache, large enough that flushes and refills are rare.
+    static const std::size_t kInsertCapacity = 512;
+    static const std::size_t kBufferSize = 512;
+    // Sequences per group before they are merged into the next group.
+    static const std::size_t kMergeWays = 64;
+
+    std::vector<TYPE> insertion;  // a heap by lowerPriority
+    std::vector<TYPE> buffer;     // sorted, most extreme last
+    std::vector<std::vector<Sequence>> groups;
+    std::size_t count = 0;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // Description: this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }  // lowerPriority()
+
+
+    // Description: Whether top() comes from the deletion buffer rather than
+    //              the insertion heap.
+    bool topIsInBuffer() const {
+        if (buffer.empty()) return false;
+        return insertion.empty() || !lowerPriority(buffer.back(), insertion.front());
+    }  // topIsInBuffer()
+
+
+    // Description: Replace everything with the elements of 'all', as one
+    //              sorted sequence.
+    void rebuildFrom(std::vector<TYPE> &&all) {
+        insertion.clear();
+        buffer.clear();
+        groups.clear();
+        count = all.size();
+        std::sort(all.begin(), all.end(), Higher { this });
+        instrument.countMoves(all.size());
+        if (!all.empty()) addSequence(0, Sequence { std::move(all), 0 });
+        refillBuffer();
+    }  // rebuildFrom()
+
+
+    // Description: Sort the full insertion heap into a new sequence. Any of
+    //              its elements more extreme than part of the deletion
+    //              buffer trade places with that part first, so the buffer
+    //              still beats every sequence.
+    void flushInsertion() {
+        std::vector<TYPE> sorted;
+        sorted.swap(insertion);
+        insertion.reserve(kInsertCapacity);
+        std::sort(sorted.begin(), sorted.end(), Higher { this });
+
+        if (!buffer.empty() && lowerPriority(buffer.front(), sorted.front())) {
+            std::vector<TYPE> merged;
+            merged.reserve(sorted.size() + buffer.size());
+            std::merge(sorted.begin(), sorted.end(), buffer.rbegin(), buffer.rend(),
+                       std::back_inserter(merged), Higher { this });
+            const auto split = merged.begin() + static_cast<std::ptrdiff_t>(buffer.size());
+            buffer.assign(std::make_reverse_iterator(split), merged.rend());
+            sorted.assign(split, merged.end());
+        }  // if
+
+        instrument.countMoves(sorted.size());
+        addSequence(0, Sequence { std::move(sorted), 0 });
+        if (buffer.empty()) refillBuffer();
+    }  // flushInsertion()
+
+
+    // Description: Add a sequence to a group, merging the group into the
+    //              next one when it is full.
+    void addSequence(std::size_t group, Sequence &&sequence) {
+        if (groups.size() <= group) groups.resize(group + 1);
+        groups[group].push_back(std::move(sequence));
+        if (groups[group].size() < kMergeWays) return;
+
+        std::vector<std::pair<typename std::vector<TYPE>::const_iterator,
+                              typename std::vector<TYPE>::const_iterator>> runs;
+        std::size_t total = 0;
+        for (const Sequence &full : groups[group]) {
+            runs.emplace_back(full.remaining(), full.elements.cend());
+            total += full.elements.size() - full.next;
+        }  // for ..full
+        std::vector<TYPE> merged;
+        merged.reserve(total);
+        mergeRuns(runs, std::back_inserter(merged), Higher { this });
+        instrument.countMoves(merged.size());
+        groups[group].clear();
+        addSequence(group + 1, Sequence { std::move(merged), 0 });
+    }  // addSequence()
+
+
+    // Description: Refill the empty deletion buffer with the kBufferSize
+    //              most extreme elements of all the sequences, dropping the
+    //              sequences that run out.
+    void refillBuffer() {
+        std::vector<Sequence *> live;
+        for (std::vector<Sequence> &group : groups) {
+            group.erase(std::remove_if(group.begin(), group.end(),
+                                       [](const Sequence &sequence) { return sequence.exhausted(); }),
+                        group.end());
+            for (Sequence &sequence : group) {
+                live.push_back(&sequence);
+            }  // for ..sequence
+        }  // for ..group
+        if (live.empty()) return;
+
+        LoserTree<TYPE, Lower> tree { live.size(), Lower { this } };
+        for (std::size_t source = 0; source < live.size(); ++source) {
+            tree.prime(source, *live[source]->remaining());
+        }  // for ..source
+        tree.build();
+
+        buffer.resize(kBufferSize);
+        auto out = buffer.rbegin();
+        for (; out != buffer.rend() && !tree.empty(); ++out) {
+            Sequence &sequence = *live[tree.topSource()];
+            *out = tree.top();
+            if (++sequence.next < sequence.elements.size()) {
+                tree.replace_top(sequence.elements[sequence.next]);
+            } else {
+                tree.exhaust_top();
+            }  // if
+        }  // for ..out
+        // Fewer than kBufferSize were left: close the gap at the front.
+        buffer.erase(buffer.begin(), out.base());
+        instrument.countMoves(buffer.size());
+    }  // refillBuffer()
+};  // SequenceHeapPQ
+
+#endif  // SEQUENCEHEAPPQ_H
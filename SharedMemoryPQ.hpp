@@ -0,0 +1,440 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef SHAREDMEMORYPQ_H
+#define SHAREDMEMORYPQ_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// A fixed-capacity binary heap that lives in a POSIX shared-memory segment,
+// so several processes on one host can push and pop the same queue
+// directly.
+//
+// The segment holds a small header (a process-shared robust mutex, the size
+// and capacity, and a futex word for wakeups) followed by the heap array.
+// One process create()s the segment by name; the others open() it. Each
+// process maps it at its own address, so TYPE must be trivially copyable
+// and must not hold pointers, and every process must use the same TYPE and
+// COMP_FUNCTOR. The segment outlives the processes until unlink()ed.
+//
+// The interface matches LockedPQ and FlatCombiningPQ (push, tryPop, size),
+// plus pop(), which blocks on a futex until an element arrives, and
+// popFor(), which gives up after a timeout.
+//
+// A push onto an empty PQ wakes every process blocked in pop(), not one:
+// there is no shared count of sleepers to go stale when one is killed,
+// but each such push makes all the sleepers contend for the lock and all
+// but one go back to sleep. Sleepers also wake every kRecheckInterval to
+// look again, so a pusher that dies between unlocking and waking them
+// delays them by that much instead of leaving them asleep for good.
+//
+// If a process dies while holding the lock, the next process to lock it
+// rebuilds the heap from the elements that were stored. An element in the
+// middle of a sift at the time may be duplicated or lost; the rest survive.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class SharedMemoryPQ {
+    static_assert(std::is_trivially_copyable<TYPE>::value,
+                  "SharedMemoryPQ requires a trivially copyable TYPE");
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+                  "the futex word must be a plain 32-bit word");
+
+public:
+    // Description: Create a new segment called 'name' (a leading '/' and no
+    //              other slashes, as for shm_open) holding up to 'capacity'
+    //              elements.
+    // Throws: std::system_error if the segment already exists or can't be
+    //         created or mapped; std::length_error if capacity is 0 or too
+    //         large.
+    static SharedMemoryPQ create(const std::string &name, std::size_t capacity,
+                                 COMP_FUNCTOR comp = COMP_FUNCTOR()) {
+        if (capacity == 0 || capacity > (SIZE_MAX - dataOffset()) / sizeof(TYPE)) {
+            throw std::length_error("SharedMemoryPQ: bad capacity");
+        }  // if
+
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) fail("shm_open " + name);
+        const std::size_t bytes = dataOffset() + capacity * sizeof(TYPE);
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            const int error = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            fail("ftruncate " + name, error);
+        }  // if
+
+        try {
+            SharedMemoryPQ pq { fd, bytes, comp };
+            Header *header = new (pq.mapping) Header {};
+            header->elementSize = sizeof(TYPE);
+            header->capacity = capacity;
+            initMutex(header->mutex);
+            header->ready.store(kMagic, std::memory_order_release);
+            pq.header = header;
+            return pq;
+        } catch (...) {
+            shm_unlink(name.c_str());
+            throw;
+        }  // try
+    }  // create()
+
+
+    // Description: Open an existing segment created with the same TYPE.
+    // Throws: std::system_error if it can't be opened or mapped;
+    //         std::runtime_error if it holds a different element type or was
+    //         never finished by its creator.
+    static SharedMemoryPQ open(const std::string &name, COMP_FUNCTOR comp = COMP_FUNCTOR()) {
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) fail("shm_open " + name);
+        struct stat info {};
+        if (fstat(fd, &info) != 0) {
+            const int error = errno;
+            close(fd);
+            fail("fstat " + name, error);
+        }  // if
+        if (static_cast<std::size_t>(info.st_size) < dataOffset()) {
+            close(fd);
+            throw std::runtime_error("SharedMemoryPQ: " + name + " is not a PQ segment");
+        }  // if
+
+        SharedMemoryPQ pq { fd, static_cast<std::size_t>(info.st_size), comp };
+        Header *header = static_cast<Header *>(pq.mapping);
+
+        // The creator may still be filling in the header.
+        for (int i = 0; header->ready.load(std::memory_order_acquire) != kMagic; ++i) {
+            if (i == 1000) throw std::runtime_error("SharedMemoryPQ: " + name + " is not a PQ segment");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }  // for ..i
+        if (header->elementSize != sizeof(TYPE)
+            || header->capacity > (pq.bytes - dataOffset()) / sizeof(TYPE)) {
+            throw std::runtime_error("SharedMemoryPQ: " + name + " holds a different element type");
+        }  // if
+        pq.header = header;
+        return pq;
+    }  // open()
+
+
+    // Description: Remove the segment's name. Processes that have it mapped
+    //              keep using it; the memory is freed when the last unmaps.
+    //              Returns false if there was no such segment.
+    static bool unlink(const std::string &name) {
+        return shm_unlink(name.c_str()) == 0;
+    }  // unlink()
+
+
+    SharedMemoryPQ(const SharedMemoryPQ &) = delete;
+    SharedMemoryPQ &operator=(const SharedMemoryPQ &) = delete;
+
+    SharedMemoryPQ(SharedMemoryPQ &&other) noexcept
+        : compare { std::move(other.compare) }
+        , fd { std::exchange(other.fd, -1) }
+        , bytes { std::exchange(other.bytes, 0) }
+        , mapping { std::exchange(other.mapping, nullptr) }
+        , header { std::exchange(other.header, nullptr) } {}
+
+    SharedMemoryPQ &operator=(SharedMemoryPQ &&rhs) noexcept {
+        if (this != &rhs) {
+            release();
+            compare = std::move(rhs.compare);
+            fd = std::exchange(rhs.fd, -1);
+            bytes = std::exchange(rhs.bytes, 0);
+            mapping = std::exchange(rhs.mapping, nullptr);
+            header = std::exchange(rhs.header, nullptr);
+        }  // if
+        return *this;
+    }  // operator=()
+
+
+    // Description: Unmap the segment; it stays in place for other processes.
+    ~SharedMemoryPQ() {
+        release();
+    }  // ~SharedMemoryPQ()
+
+
+    // Description: Add val to the PQ, waking the processes blocked in pop()
+    //              if it was empty. Returns false, leaving the PQ alone, if
+    //              it is full.
+    // Runtime: O(log(n))
+    bool tryPush(const TYPE &val) {
+        bool wasEmpty = false;
+        {
+            Lock lock { *this };
+            if (header->size == header->capacity) return false;
+            wasEmpty = header->size == 0;
+            data()[header->size] = val;
+            fixUp(header->size++);
+            header->pushes.fetch_add(1, std::memory_order_release);
+        }
+        // A process only sleeps after finding the PQ empty, so the first
+        // push after it does is onto an empty PQ: waking everyone then
+        // reaches every sleeper. The ones that find the element gone sleep
+        // again.
+        if (wasEmpty) futexWake(std::numeric_limits<int>::max());
+        return true;
+    }  // tryPush()
+
+
+    // Description: Add val to the PQ, as tryPush().
+    // Throws: std::length_error if the PQ is full.
+    // Runtime: O(log(n))
+    void push(const TYPE &val) {
+        if (!tryPush(val)) throw std::length_error("SharedMemoryPQ: push() on a full PQ");
+    }  // push()
+
+
+    // Description: Remove the most extreme element into 'out'. Returns false,
+    //              leaving 'out' alone, if the PQ was empty.
+    // Runtime: O(log(n))
+    bool tryPop(TYPE &out) {
+        Lock lock { *this };
+        return popLocked(out);
+    }  // tryPop()
+
+
+    // Description: Remove and return the most extreme element, sleeping
+    //              until one is pushed if the PQ is empty.
+    // Runtime: O(log(n)) once an element is there
+    TYPE pop() {
+        TYPE out {};
+        waitAndPop(out, nullptr);
+        return out;
+    }  // pop()
+
+
+    // Description: As pop(), but give up and return false once 'timeout'
+    //              has passed with the PQ still empty.
+    template<typename REP, typename PERIOD>
+    bool popFor(TYPE &out, std::chrono::duration<REP, PERIOD> timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        return waitAndPop(out, &deadline);
+    }  // popFor()
+
+
+    // Description: The number of elements at the time of the call.
+    [[nodiscard]] std::size_t size() const {
+        Lock lock { *const_cast<SharedMemoryPQ *>(this) };
+        return header->size;
+    }  // size()
+
+    [[nodiscard]] bool empty() const { return size() == 0; }
+    [[nodiscard]] std::size_t capacity() const { return header->capacity; }
+
+private:
+    // The start of the segment.
+    struct Header {
+        std::atomic<std::uint32_t> ready;   // kMagic once the creator is done
+        std::atomic<std::uint32_t> pushes;  // futex word, bumped by every push
+        std::uint32_t reserved;
+        std::uint64_t elementSize;
+        std::uint64_t capacity;
+        std::uint64_t size;
+        pthread_mutex_t mutex;
+    };  // Header
+
+    static const std::uint32_t kMagic = 0x50513238;  // "PQ28"
+
+    // The longest a process blocked in pop() sleeps before looking again.
+    static constexpr std::chrono::milliseconds kRecheckInterval { 50 };
+
+    // Locks the segment's mutex, repairing the heap first if its previous
+    // owner died holding it.
+    class Lock {
+    public:
+        explicit Lock(SharedMemoryPQ &pq) : pq { pq } {
+            const int result = pthread_mutex_lock(&pq.header->mutex);
+            if (result == EOWNERDEAD) {
+                pq.recover();
+                pthread_mutex_consistent(&pq.header->mutex);
+            } else if (result != 0) {
+                fail("pthread_mutex_lock", result);
+            }  // if
+        }  // Lock()
+
+        ~Lock() { pthread_mutex_unlock(&pq.header->mutex); }
+
+        Lock(const Lock &) = delete;
+        Lock &operator=(const Lock &) = delete;
+
+    private:
+        SharedMemoryPQ &pq;
+    };  // Lock
+
+    COMP_FUNCTOR compare;
+    int fd = -1;
+    std::size_t bytes = 0;
+    void *mapping = nullptr;
+    Header *header = nullptr;
+
+
+    // Description: Map 'size' bytes of the segment open on 'fd', taking
+    //              ownership of the descriptor.
+    SharedMemoryPQ(int fd, std::size_t size, COMP_FUNCTOR comp)
+        : compare { comp }, fd { fd }, bytes { size } {
+        mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            const int error = errno;
+            mapping = nullptr;
+            close(fd);
+            this->fd = -1;
+            fail("mmap", error);
+        }  // if
+    }  // SharedMemoryPQ()
+
+
+    [[noreturn]] static void fail(const std::string &what, int error = errno) {
+        throw std::system_error(error, std::generic_category(), "SharedMemoryPQ: " + what);
+    }  // fail()
+
+
+    static void initMutex(pthread_mutex_t &mutex) {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        const int result = pthread_mutex_init(&mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+        if (result != 0) fail("pthread_mutex_init", result);
+    }  // initMutex()
+
+
+    // Description: Where the heap array starts, past the header.
+    static constexpr std::size_t dataOffset() {
+        const std::size_t align = alignof(TYPE) > 64 ? alignof(TYPE) : 64;
+        return (sizeof(Header) + align - 1) / align * align;
+    }  // dataOffset()
+
+    TYPE *data() const {
+        return reinterpret_cast<TYPE *>(static_cast<char *>(mapping) + dataOffset());
+    }  // data()
+
+
+    void release() {
+        if (mapping) munmap(mapping, bytes);
+        if (fd >= 0) close(fd);
+        mapping = nullptr;
+        header = nullptr;
+        fd = -1;
+    }  // release()
+
+
+    // Description: Pop into 'out' with the lock held. Returns false if empty.
+    bool popLocked(TYPE &out) {
+        if (header->size == 0) return false;
+        TYPE *heap = data();
+        out = heap[0];
+        heap[0] = heap[--header->size];
+        fixDown(0);
+        return true;
+    }  // popLocked()
+
+
+    // Description: Pop into 'out', sleeping on the futex word while the PQ
+    //              is empty, until 'deadline' if there is one.
+    bool waitAndPop(TYPE &out, const std::chrono::steady_clock::time_point *deadline) {
+        while (true) {
+            std::uint32_t seen = 0;
+            {
+                Lock lock { *this };
+                if (popLocked(out)) return true;
+                seen = header->pushes.load(std::memory_order_acquire);
+            }
+
+            // A push after the unlock above changes the word, so the wait
+            // returns at once instead of missing it. The wait is bounded in
+            // case a pusher died before its wake.
+            bool timedOut = false;
+            std::chrono::nanoseconds wait = kRecheckInterval;
+            if (deadline) {
+                const auto left = *deadline - std::chrono::steady_clock::now();
+                if (left <= left.zero()) {
+                    timedOut = true;
+                } else if (left < wait) {
+                    wait = std::chrono::duration_cast<std::chrono::nanoseconds>(left);
+                }  // if
+            }  // if
+            if (!timedOut) {
+                const auto ns = wait.count();
+                timespec relative { static_cast<std::time_t>(ns / 1000000000),
+                                    static_cast<long>(ns % 1000000000) };
+                futexWait(seen, &relative);
+            }  // if
+
+            Lock lock { *this };
+            if (popLocked(out)) return true;
+            if (timedOut) return false;
+        }  // while
+    }  // waitAndPop()
+
+
+    std::uint32_t *futexWord() const {
+        return reinterpret_cast<std::uint32_t *>(&header->pushes);
+    }  // futexWord()
+
+    // Shared futexes (no FUTEX_PRIVATE_FLAG), as waiters are in other
+    // processes.
+    void futexWait(std::uint32_t expected, const timespec *timeout) const {
+        syscall(SYS_futex, futexWord(), FUTEX_WAIT, expected, timeout, nullptr, 0);
+    }  // futexWait()
+
+    void futexWake(int count) const {
+        syscall(SYS_futex, futexWord(), FUTEX_WAKE, count, nullptr, nullptr, 0);
+    }  // futexWake()
+
+
+    // Description: Restore the heap after a process died mid-operation.
+    void recover() {
+        if (header->size > header->capacity) header->size = header->capacity;
+        for (std::size_t i = header->size / 2; i-- > 0; ) {
+            fixDown(i);
+        }  // for ..i
+    }  // recover()
+
+
+    void fixUp(std::size_t i) {
+        TYPE *heap = data();
+        while (i > 0) {
+            std::size_t parent = (i - 1) / 2;
+            if (!compare(heap[parent], heap[i])) break;
+            std::swap(heap[parent], heap[i]);
+            i = parent;
+        }  // while
+    }  // fixUp()
+
+    void fixDown(std::size_t i) {
+        TYPE *heap = data();
+        const std::size_t size = header->size;
+        while (2 * i + 1 < size) {
+            std::size_t extreme = 2 * i + 1;
+            if (extreme + 1 < size && compare(heap[extreme], heap[extreme + 1])) ++extreme;
+            if (!compare(heap[i], heap[extreme])) break;
+            std::swap(heap[i], heap[extreme]);
+            i = extreme;
+        }  // while
+    }  // fixDown()
+};  // SharedMemoryPQ
+
+#endif  // __linux__
+
+#endif  // SHAREDMEMORYPQ_H
@@ -0,0 +1,123 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef SMALLPQ_H
+#define SMALLPQ_H
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+// A fixed-capacity priority queue for queues that never hold more than a
+// few dozen elements, such as per-request candidate lists.
+//
+// The elements live inline in a std::array kept sorted like SortedPQ's
+// vector, with the most extreme element at the back, so top() and pop() are
+// O(1) and push() is an insertion. Nothing is heap allocated and nothing is
+// virtual; the comparator is called directly and can be inlined. push()
+// finds its slot with a branch-free binary search, whose steps compile to
+// conditional moves, so random keys cause no mispredictions; the elements
+// above the slot then shift up in one straight loop, which for trivially
+// copyable TYPEs compiles to a block move.
+//
+// Everything is constexpr, so a SmallPQ can be filled and drained while
+// building a compile-time table. That needs TYPE to be a literal type and
+// COMP_FUNCTOR to have a constexpr operator(), as std::less does; TYPE
+// must also be default constructible, since every slot always holds one.
+template<typename TYPE, std::size_t N, typename COMP_FUNCTOR = std::less<TYPE>>
+class SmallPQ {
+    static_assert(N > 0, "SmallPQ needs room for at least one element");
+
+public:
+    // Description: Construct an empty PQ with an optional comparison functor.
+    // Runtime: O(N) to value-initialize the slots.
+    constexpr explicit SmallPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : compare { comp } {}
+
+
+    // Description: Construct a PQ out of an iterator range with an optional
+    //              comparison functor.
+    // Throws: std::length_error if the range holds more than N elements.
+    // Runtime: O(n * N) where n is number of elements in range.
+    template<typename InputIterator>
+    constexpr SmallPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : compare { comp } {
+        for (; start != end; ++start) {
+            push(*start);
+        }  // for ..start
+    }  // SmallPQ
+
+
+    // Description: Add a new element to the PQ, unless it is full. Returns
+    //              whether it was added.
+    // Runtime: O(log(N)) comparisons and O(N) moves
+    constexpr bool tryPush(const TYPE &val) {
+        if (count == N) return false;
+        insert(val);
+        return true;
+    }  // tryPush()
+
+
+    // Description: Add a new element to the PQ.
+    // Throws: std::length_error if the PQ is full.
+    // Runtime: O(log(N)) comparisons and O(N) moves
+    constexpr void push(const TYPE &val) {
+        if (!tryPush(val)) throw std::length_error("SmallPQ: push() on a full PQ");
+    }  // push()
+
+
+    // Description: Remove the most extreme (defined by 'compare') element from
+    //              the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: O(1)
+    constexpr void pop() { --count; }
+
+
+    // Description: Return the most extreme (defined by 'compare') element of
+    //              the PQ.
+    // Note: The PQ must not be empty.
+    // Runtime: O(1)
+    [[nodiscard]] constexpr const TYPE &top() const { return data[count - 1]; }
+
+
+    // Description: Remove every element.
+    // Runtime: O(1)
+    constexpr void clear() { count = 0; }
+
+
+    [[nodiscard]] constexpr std::size_t size() const { return count; }
+    [[nodiscard]] constexpr bool empty() const { return count == 0; }
+    [[nodiscard]] constexpr bool full() const { return count == N; }
+    [[nodiscard]] static constexpr std::size_t capacity() { return N; }
+
+private:
+    std::array<TYPE, N> data {};
+    std::size_t count = 0;
+    COMP_FUNCTOR compare;
+
+
+    // Description: Insert val into its sorted position.
+    // Note: The PQ must not be full.
+    // Runtime: O(log(N)) comparisons and O(N) moves
+    constexpr void insert(const TYPE &val) {
+        // Find the first element that beats val. Each step selects the half
+        // to keep rather than branching on it.
+        std::size_t base = 0;
+        std::size_t length = count;
+        while (length > 1) {
+            const std::size_t half = length / 2;
+            base = compare(val, data[base + half]) ? base : base + half;
+            length -= half;
+        }  // while
+        const std::size_t slot = base + (length == 1 && !compare(val, data[base]) ? 1 : 0);
+
+        for (std::size_t i = count; i > slot; --i) {
+            data[i] = std::move(data[i - 1]);
+        }  // for ..i
+        data[slot] = val;
+        ++count;
+    }  // insert()
+};  // SmallPQ
+
+#endif  // SMALLPQ_H
@@ -5,15 +5,40 @@
 
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
 
 #include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+#include "PQSnapshot.hpp"
+#include "RadixSort.hpp"
 
 // A specialized version of the priority queue ADT that is implemented with an
 // underlying sorted array-based container.
 // Note: The most extreme element should be found at the end of the
 // 'data' container, such that traversing the iterators yields the elements in
 // sorted order.
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+//
+// Elements can be cancelled in place with erase_if() or invalidate(): they
+// become tombstones, which top() and pop() never expose and size() doesn't
+// count. Tombstones that reach the back are dropped right away, and once
+// they make up more than the compaction fraction of the vector they are all
+// removed (which keeps the vector sorted, so nothing is re-sorted). Until
+// the first tombstone is created there is no per-element bookkeeping.
+// Bulk loads (the range constructor, updatePriorities()) sort the whole
+// vector. When COMP_FUNCTOR orders TYPE by an arithmetic key with std::less
+// or std::greater (see RadixSort.hpp) and TYPE is trivially copyable, that
+// is an LSD radix sort through a scratch vector kept for the next reload:
+// O(n) and comparison free, so an instrumentation policy counts no
+// comparisons there. Other comparators use std::sort.
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp). ALLOC
+// allocates the element vector; pmr::SortedPQ (below) draws it from a
+// std::pmr::memory_resource.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument,
+         typename ALLOC = std::allocator<TYPE>>
 class SortedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
@@ -21,21 +46,22 @@ class SortedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
 public:
     // Description: Construct an empty PQ with an optional comparison functor.
     // Runtime: O(1)
-    explicit SortedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
-        : BaseClass { comp } {
+    explicit SortedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(), const ALLOC &alloc = ALLOC())
+        : BaseClass { comp }, data(alloc), scratch(alloc) {
         // TODO: Implement this function, or verify that it is already done
     }  // SortedPQ
 
 
     // Description: Construct a PQ out of an iterator range with an optional
     //              comparison functor.
-    // Runtime: O(n log n) where n is number of elements in range.
+    // Runtime: O(n log n) where n is number of elements in range, O(n)
+    //          with a radix-sortable comparator.
     template<typename InputIterator>
-    SortedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
-        : BaseClass { comp } {
+    SortedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+             const ALLOC &alloc = ALLOC())
+        : BaseClass { comp }, data(alloc), scratch(alloc) {
         data.assign(start, end);
-        std::sort(data.begin(), data.end(), this->compare);
-        // TODO: Implement this function        
+        sortData();
     }  // SortedPQ
 
 
@@ -59,10 +85,12 @@ public:
     // Description: Add a new element to the PQ.
     // Runtime: O(n)
     virtual void push(const TYPE &val) {
-        // TODO: Implement this function
-        auto it = std::lower_bound(data.begin(), data.end(), val, this->compare);
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        auto it = std::lower_bound(data.begin(), data.end(), val, comparator());
+        instrument.countMoves(static_cast<std::size_t>(data.end() - it) + 1);
+        if (!tombstones.empty()) tombstones.insert(tombstones.begin() + (it - data.begin()), 0);
         data.insert(it, val);
-        }  // push()
+    }  // push()
 
 
     // Description: Remove the most extreme (defined by 'compare') element from
@@ -72,7 +100,10 @@ public:
     // familiar with them, you do not need to use exceptions in this project.
     // Runtime: Amortized O(1)
     virtual void pop() {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
         data.pop_back();
+        if (!tombstones.empty()) tombstones.pop_back();
+        discardDeadBack();
     }  // pop()
 
 
@@ -82,8 +113,7 @@ public:
     //              might make it no longer be the most extreme element.
     // Runtime: O(1)
     virtual const TYPE &top() const {
-        // TODO: Implement this function
-
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
         return data.back();
     }  // top()
 
@@ -91,31 +121,363 @@ public:
     // Description: Get the number of elements in the PQ.
     //              This has been implemented for you.
     // Runtime: O(1)
-    [[nodiscard]] virtual std::size_t size() const { return data.size(); }
+    [[nodiscard]] virtual std::size_t size() const { return data.size() - numDead; }
 
 
     // Description: Return true if the PQ is empty.
     //              This has been implemented for you.
+    // Note: The back is never a tombstone, so the vector is empty exactly
+    //       when there are no live elements.
     // Runtime: O(1)
     [[nodiscard]] virtual bool empty() const { return data.empty(); }
 
 
     // Description: Assumes that all elements inside the PQ are out of order and
     //              'rebuilds' the PQ by fixing the PQ invariant.
-    // Runtime: O(n log n)
+    // Runtime: O(n log n), O(n) with a radix-sortable comparator
     virtual void updatePriorities() {
-        // TODO: Implement this function
-        std::sort(data.begin(), data.end(), this->compare);
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+        dirty.clear();
+        removeTombstones();
+        sortData();
     }  // updatePriorities()
 
 
+    // Description: Pop every element for which pred(element) is true into
+    //              'out', most extreme first (see Eecs281PQ::drain_while()).
+    //              They are a suffix of the vector: one binary search finds
+    //              it, and one erase removes it.
+    // Runtime: O(log(n) + k) for k elements drained
+    template<typename PREDICATE, typename OutputIterator>
+    OutputIterator drain_while(PREDICATE pred, OutputIterator out) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
+        const auto first = std::partition_point(data.begin(), data.end(),
+                                                [&pred](const TYPE &val) { return !pred(val); });
+        const auto from = static_cast<std::size_t>(first - data.begin());
+        for (std::size_t i = data.size(); i-- > from; ) {
+            if (isDead(i)) {
+                --numDead;
+                continue;
+            }  // if
+            *out = std::move(data[i]);
+            ++out;
+        }  // for ..i
+        data.erase(first, data.end());
+        if (!tombstones.empty()) tombstones.resize(data.size());
+        discardDeadBack();
+        return out;
+    }  // drain_while()
+
+
+    // Description: Pop every element more extreme than 'threshold' into
+    //              'out', most extreme first.
+    // Runtime: O(log(n) + k) for k elements drained
+    template<typename OutputIterator>
+    OutputIterator pop_above(const TYPE &threshold, OutputIterator out) {
+        return drain_while([this, &threshold](const TYPE &val) { return lowerPriority(threshold, val); }, out);
+    }  // pop_above()
+
+
+    // Description: Turn every live element for which pred(element) is true
+    //              into a tombstone. Returns how many were erased.
+    // Runtime: O(n)
+    template<typename PREDICATE>
+    std::size_t erase_if(PREDICATE pred) {
+        std::size_t erased = 0;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (!isDead(i) && pred(data[i])) {
+                markDead(i);
+                ++erased;
+            }  // if
+        }  // for ..i
+        if (erased > 0) settleTombstones();
+        return erased;
+    }  // erase_if()
+
+
+    // Description: Turn one live element equal to val (by operator==) into a
+    //              tombstone. Returns false if there was none.
+    // Runtime: O(log(n)) to find the run of equivalent elements, plus its
+    //          length
+    bool invalidate(const TYPE &val) {
+        const auto range = std::equal_range(data.begin(), data.end(), val, comparator());
+        for (auto it = range.first; it != range.second; ++it) {
+            const auto i = static_cast<std::size_t>(it - data.begin());
+            if (!isDead(i) && data[i] == val) {
+                markDead(i);
+                settleTombstones();
+                return true;
+            }  // if
+        }  // for ..it
+        return false;
+    }  // invalidate()
+
+
+    // Description: Set the fraction of the vector that tombstones may
+    //              occupy before they are all removed (default 0.5).
+    // Runtime: O(1)
+    void setCompactionFraction(double fraction) { compactionFraction = fraction; }
+
+
+    // Description: Record that every element equal to val (by operator==)
+    //              may have changed priority, for the next updateDirty().
+    //              Returns how many elements were marked.
+    // Runtime: O(n), but without any comparisons
+    std::size_t markDirty(const TYPE &val) {
+        return markDirtyIf([&val](const TYPE &elt) { return elt == val; });
+    }  // markDirty()
+
+
+    // Description: Record that every element for which pred(element) is true
+    //              may have changed priority. Returns how many were marked.
+    // Runtime: O(n)
+    template<typename PREDICATE>
+    std::size_t markDirtyIf(PREDICATE pred) {
+        std::size_t marked = 0;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (pred(data[i])) {
+                dirty.push_back(i);
+                ++marked;
+            }  // if
+        }  // for ..i
+        return marked;
+    }  // markDirtyIf()
+
+
+    // Description: Restore sorted order after changing only the elements
+    //              marked dirty: pull them out, sort just those, and merge
+    //              them back in with a binary search each. Falls back to a
+    //              full sort when half the vector is dirty. Tombstones are
+    //              dropped on the way.
+    // Note: Nothing else may be done to the PQ between marking and calling
+    //       updateDirty(), as a push or pop would move the marked slots.
+    // Runtime: O(n + k log(n)) for k dirty elements
+    void updateDirty() {
+        if (dirty.empty()) return;
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        if (dirty.size() >= data.size() / 2) {
+            updatePriorities();
+            return;
+        }  // if
+
+        typename INSTRUMENT::Scope scope { instrument, PQOp::UpdatePriorities };
+        std::vector<TYPE> moved;
+        moved.reserve(dirty.size());
+        std::size_t out = 0;
+        std::size_t next = 0;
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            const bool isDirty = next < dirty.size() && dirty[next] == i;
+            if (isDirty) ++next;
+            if (isDead(i)) continue;
+
+            if (isDirty) {
+                moved.push_back(std::move(data[i]));
+            } else {
+                if (out != i) data[out] = std::move(data[i]);
+                ++out;
+            }  // if
+        }  // for ..i
+        data.resize(out);
+        dirty.clear();
+        tombstones.clear();
+        numDead = 0;
+
+        // Merge back from the end: each moved element, largest first, finds
+        // its place by binary search and the block above it shifts up once.
+        std::sort(moved.begin(), moved.end(), comparator());
+        data.insert(data.end(), moved.begin(), moved.end());
+        auto kept = data.end() - static_cast<std::ptrdiff_t>(moved.size());
+        auto write = data.end();
+        for (auto it = moved.rbegin(); it != moved.rend(); ++it) {
+            const auto slot = std::upper_bound(data.begin(), kept, *it, comparator());
+            instrument.countMoves(static_cast<std::size_t>(kept - slot) + 1);
+            write = std::move_backward(slot, kept, write);
+            *--write = std::move(*it);
+            kept = slot;
+        }  // for ..it
+    }  // updateDirty()
+
+
+    // Description: Write the PQ's live contents to a snapshot file at 'path'
+    //              (see PQSnapshot.hpp). TYPE must be trivially copyable.
+    // Throws: std::runtime_error if the file can't be written.
+    // Runtime: O(n)
+    void save(const std::string &path) const {
+        if (numDead == 0) {
+            writeSnapshot(path, SnapshotKind::Sorted, data.data(), data.size());
+            return;
+        }  // if
+
+        std::vector<TYPE> live;
+        live.reserve(size());
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (tombstones[i] == 0) live.push_back(data[i]);
+        }  // for ..i
+        writeSnapshot(path, SnapshotKind::Sorted, live.data(), live.size());
+    }  // save()
+
+
+    // Description: Replace the PQ's contents with a snapshot written by
+    //              save(). A sorted snapshot is used as is;
+    //              any other array snapshot is sorted.
+    //              The snapshot must have been saved with the same COMP_FUNCTOR.
+    // Throws: std::runtime_error if the snapshot is unreadable or corrupt;
+    //         the PQ is then left empty.
+    // Runtime: O(n) for a sorted snapshot, else O(n log n)
+    void load(const std::string &path) {
+        dirty.clear();
+        tombstones.clear();
+        numDead = 0;
+        if (readArraySnapshot(path, data) != SnapshotKind::Sorted) {
+            sortData();
+        }  // if
+    }  // load()
+
+
+    // Description: Move the live elements out, sorted with the most extreme
+    //              last, leaving the PQ empty. Used to hand the vector to
+    //              another PQ without copying it.
+    // Runtime: O(1), or O(n) if there are tombstones to drop
+    std::vector<TYPE, ALLOC> releaseData() {
+        dirty.clear();
+        removeTombstones();
+        std::vector<TYPE, ALLOC> result = std::move(data);
+        data.clear();
+        return result;
+    }  // releaseData()
+
+
+    // Description: Replace the PQ's contents with 'elements', taking over
+    //              the vector rather than copying it. 'arrangement' says how
+    //              they are already ordered (as in a snapshot); sorted
+    //              elements are used as is, anything else is sorted.
+    // Runtime: O(1) if already sorted, else O(n log n)
+    void adoptData(std::vector<TYPE, ALLOC> &&elements, SnapshotKind arrangement = SnapshotKind::Unordered) {
+        dirty.clear();
+        tombstones.clear();
+        numDead = 0;
+        data = std::move(elements);
+        if (arrangement != SnapshotKind::Sorted) {
+            sortData();
+        }  // if
+    }  // adoptData()
+
+
+    // Description: Access the instrumentation policy, e.g. to dump() or
+    //              reset() a CountingInstrument.
+    // Runtime: O(1)
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+
+    // Description: Return a copy of the allocator of the element vector.
+    // Runtime: O(1)
+    ALLOC get_allocator() const { return data.get_allocator(); }
+
+
 private:
     // Note: This vector *must* be used for your PQ implementation.
-    std::vector<TYPE> data;
+    std::vector<TYPE, ALLOC> data;
+
+    // Whether sortData() can radix sort.
+    static constexpr bool kRadixSortable = RadixKey<TYPE, COMP_FUNCTOR>::enabled
+                                           && std::is_trivially_copyable_v<TYPE>
+                                           && std::is_default_constructible_v<TYPE>;
+    // The radix sort's second buffer, kept between bulk loads.
+    RadixScratch<TYPE, ALLOC> scratch;
+
+    // tombstones[i] is set if data[i] has been erased. Empty while there
+    // are no tombstones, so push() doesn't pay for it until then.
+    std::vector<unsigned char> tombstones;
+    std::size_t numDead = 0;
+    double compactionFraction = 0.5;
+
+    // Slots marked by markDirty()/markDirtyIf() since the last repair.
+    std::vector<std::size_t> dirty;
 
-    // TODO: Add any additional member functions you require here.
-    //       You are NOT allowed to add any new member variables.
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // Description: this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }  // lowerPriority()
+
+    // Description: lowerPriority() wrapped up as a functor for the standard
+    //              algorithms.
+    auto comparator() const {
+        return [this](const TYPE &a, const TYPE &b) { return lowerPriority(a, b); };
+    }  // comparator()
+
+    bool isDead(std::size_t i) const { return !tombstones.empty() && tombstones[i] != 0; }
+
+    void markDead(std::size_t i) {
+        if (tombstones.empty()) tombstones.assign(data.size(), 0);
+        tombstones[i] = 1;
+        ++numDead;
+    }  // markDead()
+
+    // Description: Drop tombstones off the back until a live element is
+    //              there (or the vector is empty).
+    void discardDeadBack() {
+        while (numDead > 0 && !data.empty() && tombstones.back() != 0) {
+            --numDead;
+            data.pop_back();
+            tombstones.pop_back();
+        }  // while
+        if (numDead == 0) tombstones.clear();
+    }  // discardDeadBack()
+
+    // Description: After new tombstones, compact if there are too many,
+    //              otherwise just make sure the back is live.
+    void settleTombstones() {
+        if (static_cast<double>(numDead) > compactionFraction * static_cast<double>(data.size())) {
+            removeTombstones();
+        } else {
+            discardDeadBack();
+        }  // if
+    }  // settleTombstones()
+
+    // Description: Drop every tombstone from data, keeping the rest in order.
+    // Runtime: O(n)
+    void removeTombstones() {
+        if (numDead > 0) {
+            std::size_t out = 0;
+            for (std::size_t i = 0; i < data.size(); ++i) {
+                if (tombstones[i] != 0) continue;
+                if (out != i) data[out] = std::move(data[i]);
+                ++out;
+            }  // for ..i
+            data.resize(out);
+            numDead = 0;
+        }  // if
+        tombstones.clear();
+    }  // removeTombstones()
+
+    // Description: Restore sorted order over the whole data vector.
+    // Runtime: O(n log n), O(n) with a radix-sortable comparator
+    void sortData() {
+        if constexpr (kRadixSortable) {
+            if (data.size() >= radixSortCutoff<TYPE, COMP_FUNCTOR>) {
+                radixSort(data, scratch.buffer, this->compare);
+                return;
+            }  // if
+        }  // if
+        std::sort(data.begin(), data.end(), comparator());
+    }  // sortData()
 
 };  // SortedPQ
 
+
+namespace pmr {
+
+// SortedPQ whose elements live in a std::pmr::memory_resource, passed after
+// the comparator: pmr::SortedPQ<int> pq { std::less<int>(), &arena };
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+using SortedPQ = ::SortedPQ<TYPE, COMP_FUNCTOR, INSTRUMENT, std::pmr::polymorphic_allocator<TYPE>>;
+
+}  // namespace pmr
+
 #endif  // SORTEDPQ_H
@@ -0,0 +1,86 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <cstddef>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+
+// A bounded selector that keeps the K most extreme (defined by 'compare')
+// elements of a stream.
+//
+// Internally this is a BinaryPQ with the comparator reversed, so its top()
+// is the *worst* element kept. Once K elements are held, every new element
+// costs one comparison against that worst element, and at most one sift
+// (replace_top) if it is admitted, instead of a push and a pop.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+class TopK {
+public:
+    // Description: Construct an empty selector for the best k elements with
+    //              an optional comparison functor.
+    // Runtime: O(1)
+    explicit TopK(std::size_t k, COMP_FUNCTOR comp = COMP_FUNCTOR())
+        : heap { Reversed { comp } }
+        , compare { comp }
+        , k { k } {}
+
+
+    // Description: Offer val to the selector. Returns true if it is now one
+    //              of the K best, false if it was rejected.
+    // Runtime: O(1) if rejected, otherwise O(log(k))
+    bool push(const TYPE &val) {
+        if (heap.size() < k) {
+            heap.push(val);
+            return true;
+        }  // if
+
+        // Early reject: not better than the worst element we keep.
+        if (k == 0 || !compare(heap.top(), val)) return false;
+
+        heap.replace_top(val);
+        return true;
+    }  // push()
+
+
+    // Description: Return the worst of the elements kept, i.e. the bar a new
+    //              element has to beat once the selector is full.
+    // Note: The selector must not be empty.
+    // Runtime: O(1)
+    const TYPE &worst() const { return heap.top(); }
+
+
+    // Description: Remove and return every element kept, most extreme first.
+    // Runtime: O(k log(k))
+    std::vector<TYPE> extract() {
+        std::vector<TYPE> result(heap.size());
+        for (auto it = result.rbegin(); it != result.rend(); ++it) {
+            *it = heap.top();
+            heap.pop();
+        }  // for ..it
+        return result;
+    }  // extract()
+
+
+    [[nodiscard]] std::size_t size() const { return heap.size(); }
+    [[nodiscard]] std::size_t capacity() const { return k; }
+    [[nodiscard]] bool empty() const { return heap.empty(); }
+    [[nodiscard]] bool full() const { return heap.size() == k; }
+
+private:
+    // Flips the comparator so that the heap's top() is the worst element.
+    struct Reversed {
+        COMP_FUNCTOR comp;
+
+        bool operator()(const TYPE &a, const TYPE &b) const {
+            return comp(b, a);
+        }  // operator()()
+    };  // Reversed
+
+    BinaryPQ<TYPE, Reversed> heap;
+    COMP_FUNCTOR compare;
+    std::size_t k;
+};  // TopK
+
+#endif  // TOPK_H
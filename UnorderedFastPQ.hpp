@@ -4,8 +4,13 @@
 #define UNORDEREDFASTPQ_H
 
 #include <limits>  // needed for kUnknown
+#include <memory>
+#include <memory_resource>
+#include <vector>
 
 #include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+#include "PQSnapshot.hpp"
 
 static const size_t kUnknown = std::numeric_limits<size_t>::max();
 
@@ -21,7 +26,11 @@ static const size_t kUnknown = std::numeric_limits<size_t>::max();
 // Pay particular attention to how the constructors and findExtreme()
 // are written, especially the use of this->compare.
 
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp). ALLOC
+// allocates the element vector; pmr::UnorderedFastPQ (below) draws it from a
+// std::pmr::memory_resource.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument,
+         typename ALLOC = std::allocator<TYPE>>
 class UnorderedFastPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
@@ -29,8 +38,9 @@ class UnorderedFastPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
 public:
     // Description: Construct an empty PQ with optional comparison functor.
     // Runtime: O(1)
-    explicit UnorderedFastPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
+    explicit UnorderedFastPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(), const ALLOC &alloc = ALLOC())
         : BaseClass { comp }
+        , data(alloc)
         , extreme { kUnknown } {}  // UnorderedFastPQ()
 
 
@@ -38,9 +48,10 @@ public:
     //              comparison functor.
     // Runtime: O(n) where n is number of elements in range.
     template<typename InputIterator>
-    UnorderedFastPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+    UnorderedFastPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                    const ALLOC &alloc = ALLOC())
         : BaseClass { comp }
-        , data { start, end }
+        , data(start, end, alloc)
         , extreme { kUnknown } {}
 
 
@@ -70,6 +81,7 @@ public:
     // Description: Add a new element to the PQ.
     // Runtime: Amortized O(1)
     virtual void push(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
         data.push_back(val);
 
         // Since a new element has been added, we no longer know where to
@@ -87,6 +99,7 @@ public:
     // Note: If the most extreme element is already known (as would happen if
     //       .top() was called before .pop()), this function is O(1).
     virtual void pop() {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
         // If the index of the most extreme element is unknown, find it.
         if (extreme == kUnknown) {
             findExtreme();
@@ -97,6 +110,7 @@ public:
         // of a vector.
         data[extreme] = data.back();
         data.pop_back();
+        instrument.countMoves(1);
 
         // Since the most extreme element has been removed, we no longer know
         // where to find it.
@@ -111,6 +125,7 @@ public:
     //              element.
     // Runtime: O(n)
     virtual const TYPE &top() const {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
         // If the index of the most extreme element is unknown, find it.
         if (extreme == kUnknown) {
             findExtreme();
@@ -130,9 +145,75 @@ public:
     virtual bool empty() const { return data.empty(); }
 
 
+    // Description: Write the PQ's contents to a snapshot file at 'path'
+    //              (see PQSnapshot.hpp). TYPE must be trivially copyable.
+    // Throws: std::runtime_error if the file can't be written.
+    // Runtime: O(n)
+    void save(const std::string &path) const {
+        writeSnapshot(path, SnapshotKind::Unordered, data.data(), data.size());
+    }  // save()
+
+
+    // Description: Replace the PQ's contents with a snapshot written by
+    //              save(). Any array snapshot can be loaded.
+    // Throws: std::runtime_error if the snapshot is unreadable or corrupt;
+    //         the PQ is then left empty.
+    // Runtime: O(n)
+    void load(const std::string &path) {
+        extreme = kUnknown;
+        readArraySnapshot(path, data);
+    }  // load()
+
+
+    // Description: Move the elements out, leaving the PQ empty. Used to
+    //              hand the vector to another PQ without copying it.
+    // Runtime: O(1)
+    std::vector<TYPE, ALLOC> releaseData() {
+        extreme = kUnknown;
+        std::vector<TYPE, ALLOC> result = std::move(data);
+        data.clear();
+        return result;
+    }  // releaseData()
+
+
+    // Description: Replace the PQ's contents with 'elements', taking over
+    //              the vector rather than copying it. Any order will do, but
+    //              if 'arrangement' says where the most extreme element is
+    //              (the front of a heap, the back of a sorted vector), the
+    //              first top() needn't search for it.
+    // Runtime: O(1)
+    void adoptData(std::vector<TYPE, ALLOC> &&elements, SnapshotKind arrangement = SnapshotKind::Unordered) {
+        data = std::move(elements);
+        extreme = kUnknown;
+        if (!data.empty() && arrangement == SnapshotKind::Heap) extreme = 0;
+        if (!data.empty() && arrangement == SnapshotKind::Sorted) extreme = data.size() - 1;
+    }  // adoptData()
+
+
+    // Description: Access the instrumentation policy, e.g. to dump() or
+    //              reset() a CountingInstrument.
+    // Runtime: O(1)
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+
+    // Description: Return a copy of the allocator of the element vector.
+    // Runtime: O(1)
+    ALLOC get_allocator() const { return data.get_allocator(); }
+
+
 private:
     // Note: This vector *must* be used for your PQ implementation.
-    std::vector<TYPE> data;
+    std::vector<TYPE, ALLOC> data;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // Description: this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }  // lowerPriority()
 
     // A member variable that can be changed by a const member function;
     // stores the index of the most extreme element, or kUnknown.
@@ -146,7 +227,7 @@ private:
         size_t index = 0;
 
         for (size_t i = 1; i < data.size(); ++i) {
-            if (this->compare(data[index], data[i])) {
+            if (lowerPriority(data[index], data[i])) {
                 index = i;
             }  // if ..compare
         }  // for ..i
@@ -155,4 +236,14 @@ private:
     }  // findExtreme()
 };  // UnorderedFastPQ
 
+
+namespace pmr {
+
+// UnorderedFastPQ whose elements live in a std::pmr::memory_resource, passed after
+// the comparator: pmr::UnorderedFastPQ<int> pq { std::less<int>(), &arena };
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+using UnorderedFastPQ = ::UnorderedFastPQ<TYPE, COMP_FUNCTOR, INSTRUMENT, std::pmr::polymorphic_allocator<TYPE>>;
+
+}  // namespace pmr
+
 #endif  // UNORDEREDFASTPQ_H
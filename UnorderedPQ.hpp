@@ -4,7 +4,13 @@
 #ifndef UNORDEREDPQ_H
 #define UNORDEREDPQ_H
 
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
 #include "Eecs281PQ.hpp"
+#include "PQInstrument.hpp"
+#include "PQSnapshot.hpp"
 
 // A specialized version of the priority queue ADT that is implemented with
 // an underlying unordered array-based container that is linearly searched
@@ -14,7 +20,11 @@
 // Pay particular attention to how the constructors and findExtreme()
 // are written, especially the use of this->compare.
 
-template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>>
+// INSTRUMENT is an instrumentation policy (see PQInstrument.hpp). ALLOC
+// allocates the element vector; pmr::UnorderedPQ (below) draws it from a
+// std::pmr::memory_resource.
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument,
+         typename ALLOC = std::allocator<TYPE>>
 class UnorderedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
     // This is a way to refer to the base class object.
     using BaseClass = Eecs281PQ<TYPE, COMP_FUNCTOR>;
@@ -22,17 +32,19 @@ class UnorderedPQ : public Eecs281PQ<TYPE, COMP_FUNCTOR> {
 public:
     // Description: Construct an empty PQ with optional comparison functor.
     // Runtime: O(1)
-    explicit UnorderedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR())
-        : BaseClass { comp } {}  // UnorderedPQ()
+    explicit UnorderedPQ(COMP_FUNCTOR comp = COMP_FUNCTOR(), const ALLOC &alloc = ALLOC())
+        : BaseClass { comp }
+        , data(alloc) {}  // UnorderedPQ()
 
 
     // Description: Construct a PQ out of an iterator range with optional
     //              comparison functor.
     // Runtime: O(n) where n is number of elements in range.
     template<typename InputIterator>
-    UnorderedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR())
+    UnorderedPQ(InputIterator start, InputIterator end, COMP_FUNCTOR comp = COMP_FUNCTOR(),
+                const ALLOC &alloc = ALLOC())
         : BaseClass { comp }
-        , data { start, end } {}
+        , data(start, end, alloc) {}
 
 
     // Description: Destructor doesn't need any code, the data vector will
@@ -60,7 +72,10 @@ public:
 
     // Description: Add a new element to the PQ.
     // Runtime: Amortized O(1)
-    virtual void push(const TYPE &val) { data.push_back(val); }
+    virtual void push(const TYPE &val) {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Push };
+        data.push_back(val);
+    }  // push()
 
 
     // Description: Remove the most extreme (defined by 'compare') element
@@ -72,11 +87,13 @@ public:
     // Note: If the most extreme element is already known (as would happen if
     //       .top() was called before .pop()), this function is O(1).
     virtual void pop() {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Pop };
         // Replace the most extreme element with the element at the back,
         // then pop_back().  This is much faster than erasing from the middle
         // of a vector.
         data[findExtreme()] = data.back();
         data.pop_back();
+        instrument.countMoves(1);
     }  // pop()
 
 
@@ -87,6 +104,7 @@ public:
     //              element.
     // Runtime: O(n)
     virtual const TYPE &top() const {
+        typename INSTRUMENT::Scope scope { instrument, PQOp::Top };
         // Find the most extreme element and return it by const reference.
         return data[findExtreme()];
     }  // top()
@@ -100,9 +118,67 @@ public:
     // Runtime: O(1)
     [[nodiscard]] virtual bool empty() const { return data.empty(); }
 
+
+    // Description: Write the PQ's contents to a snapshot file at 'path'
+    //              (see PQSnapshot.hpp). TYPE must be trivially copyable.
+    // Throws: std::runtime_error if the file can't be written.
+    // Runtime: O(n)
+    void save(const std::string &path) const {
+        writeSnapshot(path, SnapshotKind::Unordered, data.data(), data.size());
+    }  // save()
+
+
+    // Description: Replace the PQ's contents with a snapshot written by
+    //              save(). Any array snapshot can be loaded.
+    // Throws: std::runtime_error if the snapshot is unreadable or corrupt;
+    //         the PQ is then left empty.
+    // Runtime: O(n)
+    void load(const std::string &path) {
+        readArraySnapshot(path, data);
+    }  // load()
+
+
+    // Description: Move the elements out, leaving the PQ empty. Used to
+    //              hand the vector to another PQ without copying it.
+    // Runtime: O(1)
+    std::vector<TYPE, ALLOC> releaseData() {
+        std::vector<TYPE, ALLOC> result = std::move(data);
+        data.clear();
+        return result;
+    }  // releaseData()
+
+
+    // Description: Replace the PQ's contents with 'elements', taking over
+    //              the vector rather than copying it. Any order will do.
+    // Runtime: O(1)
+    void adoptData(std::vector<TYPE, ALLOC> &&elements, SnapshotKind = SnapshotKind::Unordered) {
+        data = std::move(elements);
+    }  // adoptData()
+
+
+    // Description: Access the instrumentation policy, e.g. to dump() or
+    //              reset() a CountingInstrument.
+    // Runtime: O(1)
+    const INSTRUMENT &instrumentation() const { return instrument; }
+    INSTRUMENT &instrumentation() { return instrument; }
+
+
+    // Description: Return a copy of the allocator of the element vector.
+    // Runtime: O(1)
+    ALLOC get_allocator() const { return data.get_allocator(); }
+
 private:
     // Note: This vector *must* be used for your PQ implementation.
-    std::vector<TYPE> data;
+    std::vector<TYPE, ALLOC> data;
+
+    // Mutable so that const member functions can still count and time.
+    mutable INSTRUMENT instrument;
+
+    // Description: this->compare, routed through the instrumentation policy.
+    bool lowerPriority(const TYPE &a, const TYPE &b) const {
+        instrument.countCompare();
+        return this->compare(a, b);
+    }  // lowerPriority()
 
     // Description: Find the 'most extreme' element of the data vector, using
     //              this->compare() to check if one element is 'less than'
@@ -112,7 +188,7 @@ private:
         size_t index = 0;
 
         for (size_t i = 1; i < data.size(); ++i) {
-            if (this->compare(data[index], data[i])) {
+            if (lowerPriority(data[index], data[i])) {
                 index = i;
             }  // if ..compare()
         }  // for ..i
@@ -121,4 +197,14 @@ private:
     }  // findExtreme()
 };  // UnorderedPQ
 
+
+namespace pmr {
+
+// UnorderedPQ whose elements live in a std::pmr::memory_resource, passed after
+// the comparator: pmr::UnorderedPQ<int> pq { std::less<int>(), &arena };
+template<typename TYPE, typename COMP_FUNCTOR = std::less<TYPE>, typename INSTRUMENT = NullInstrument>
+using UnorderedPQ = ::UnorderedPQ<TYPE, COMP_FUNCTOR, INSTRUMENT, std::pmr::polymorphic_allocator<TYPE>>;
+
+}  // namespace pmr
+
 #endif  // UNORDEREDPQ_H
@@ -0,0 +1,186 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Contention benchmark: FlatCombiningPQ against LockedPQ (one mutex around
+ * the queue), each over BinaryPQ and PairingPQ.
+ *
+ * The queue is prefilled, then every thread runs the same number of
+ * operations, alternating push(random key) and tryPop(), so the size stays
+ * roughly constant. The thread count doubles from 1 up to the maximum.
+ * Results are total operations per second across all threads; for the
+ * flat-combining queues the average number of requests each combining pass
+ * applied is shown as well.
+ *
+ * Usage: ./benchConcurrent [-n ops] [-f prefill] [-T max-threads] [-s seed]
+ *   -n, --ops          operations per run, split across the threads
+ *                      (default 400000)
+ *   -f, --prefill      elements in the queue before timing (default 100000)
+ *   -T, --max-threads  largest thread count (default 64)
+ *   -s, --seed         random seed (default 281)
+ *
+ * Build with 'make bench' (release flags).
+ */
+
+#include <getopt.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+#include "FlatCombiningPQ.hpp"
+#include "PairingPQ.hpp"
+
+namespace {
+
+struct Options {
+    std::size_t ops = 400000;
+    std::size_t prefill = 100000;
+    std::size_t maxThreads = 64;
+    std::uint32_t seed = 281;
+};  // Options
+
+
+// Keeps the optimizer from discarding the popped values.
+std::atomic<std::int64_t> sink { 0 };
+
+
+Options parseOptions(int argc, char *argv[]) {
+    Options options;
+    const option longOptions[] = {
+        { "ops", required_argument, nullptr, 'n' },
+        { "prefill", required_argument, nullptr, 'f' },
+        { "max-threads", required_argument, nullptr, 'T' },
+        { "seed", required_argument, nullptr, 's' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 },
+    };
+
+    int choice = 0;
+    while ((choice = getopt_long(argc, argv, "n:f:T:s:h", longOptions, nullptr)) != -1) {
+        switch (choice) {
+        case 'n':
+            options.ops = std::stoul(optarg);
+            break;
+        case 'f':
+            options.prefill = std::stoul(optarg);
+            break;
+        case 'T':
+            options.maxThreads = std::stoul(optarg);
+            break;
+        case 's':
+            options.seed = static_cast<std::uint32_t>(std::stoul(optarg));
+            break;
+        case 'h':
+            std::cout << "Usage: " << argv[0] << " [-n ops] [-f prefill] [-T max-threads] [-s seed]\n";
+            std::exit(0);
+        default:
+            std::cerr << "Unknown option, try --help\n";
+            std::exit(1);
+        }  // switch
+    }  // while
+
+    if (options.maxThreads == 0) options.maxThreads = 1;
+    return options;
+}  // parseOptions()
+
+
+// Average requests per combining pass, or nothing for LockedPQ.
+template <typename QUEUE>
+std::string batchSize(const QUEUE &) {
+    return "-";
+}  // batchSize()
+
+template <typename TYPE, typename COMP, template <typename...> typename PQ>
+std::string batchSize(const FlatCombiningPQ<TYPE, COMP, PQ> &queue) {
+    if (queue.batchCount() == 0) return "-";
+    const double average = static_cast<double>(queue.combinedCount())
+                           / static_cast<double>(queue.batchCount());
+    std::string text = std::to_string(average);
+    return text.substr(0, text.find('.') + 3);
+}  // batchSize()
+
+
+// Run one thread count against a freshly prefilled QUEUE.
+template <typename QUEUE>
+void benchOne(const char *name, std::size_t threads, const Options &options) {
+    QUEUE queue {};
+    std::mt19937 rng { options.seed };
+    std::uniform_int_distribution<int> dist;
+    for (std::size_t i = 0; i < options.prefill; ++i) {
+        queue.push(dist(rng));
+    }  // for ..i
+
+    const std::size_t perThread = options.ops / threads;
+    std::atomic<std::size_t> ready { 0 };
+    std::atomic<bool> go { false };
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&queue, &ready, &go, perThread, t, &options] {
+            std::mt19937 local { options.seed + static_cast<std::uint32_t>(t) + 1 };
+            std::uniform_int_distribution<int> keys;
+            std::int64_t sum = 0;
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (std::size_t i = 0; i < perThread; ++i) {
+                if (i % 2 == 0) {
+                    queue.push(keys(local));
+                } else {
+                    int val = 0;
+                    if (queue.tryPop(val)) sum += val;
+                }  // if
+            }  // for ..i
+            sink.fetch_add(sum, std::memory_order_relaxed);
+        });
+    }  // for ..t
+
+    while (ready.load() < threads) std::this_thread::yield();
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &worker : workers) {
+        worker.join();
+    }  // for ..worker
+    const double seconds
+        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(8) << threads
+              << std::fixed << std::setprecision(3) << std::setw(12)
+              << static_cast<double>(perThread * threads) / seconds / 1e6
+              << std::setw(10) << batchSize(queue) << '\n';
+}  // benchOne()
+
+
+template <typename QUEUE>
+void benchQueue(const char *name, const Options &options) {
+    for (std::size_t threads = 1; threads <= options.maxThreads; threads *= 2) {
+        benchOne<QUEUE>(name, threads, options);
+    }  // for ..threads
+    std::cout << '\n';
+}  // benchQueue()
+
+}  // namespace
+
+
+int main(int argc, char *argv[]) {
+    std::ios_base::sync_with_stdio(false);
+    const Options options = parseOptions(argc, argv);
+
+    std::cout << "ops = " << options.ops << ", prefill = " << options.prefill
+              << ", cores = " << std::thread::hardware_concurrency()
+              << ", seed = " << options.seed << "\n\n";
+    std::cout << std::left << std::setw(16) << "queue" << std::right << std::setw(8) << "threads"
+              << std::setw(12) << "Mops/s" << std::setw(10) << "batch" << "\n";
+
+    benchQueue<LockedPQ<int, std::less<int>, BinaryPQ>>("Locked/Binary", options);
+    benchQueue<FlatCombiningPQ<int, std::less<int>, BinaryPQ>>("FC/Binary", options);
+    benchQueue<LockedPQ<int, std::less<int>, PairingPQ>>("Locked/Pairing", options);
+    benchQueue<FlatCombiningPQ<int, std::less<int>, PairingPQ>>("FC/Pairing", options);
+
+    return 0;
+}  // main()
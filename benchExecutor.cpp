@@ -0,0 +1,222 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Benchmark for PriorityExecutor with each PQ engine.
+ *
+ * The workload mixes three classes of CPU-bound task, shuffled together:
+ *   urgent  - short tasks at the highest priority (20%)
+ *   normal  - short tasks at middling priorities (70%)
+ *   long    - tasks about 100 times longer, at the lowest priority (10%)
+ *
+ * It runs in two scenarios:
+ *   external - every task is posted from the main thread, so they are dealt
+ *              round-robin across the worker queues
+ *   spawned  - one task posts all the others, so they all land on a single
+ *              worker's queue and the rest have to steal them
+ *
+ * For each run it reports throughput (tasks per second, from the first post
+ * to the last task finishing), the number of steals, and for every class
+ * the median and 99th percentile latency from post to the task starting.
+ * A good engine keeps urgent latency low while long tasks are waiting.
+ *
+ * Usage: ./benchExecutor [-n tasks] [-t threads] [-s seed]
+ *   -n, --tasks    number of tasks per run (default 20000)
+ *   -t, --threads  worker threads (default: hardware concurrency)
+ *   -s, --seed     random seed (default 281)
+ *
+ * Build with 'make bench' (release flags).
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+#include "CompactPairingPQ.hpp"
+#include "PairingPQ.hpp"
+#include "PriorityExecutor.hpp"
+#include "RankPairingPQ.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::size_t tasks = 20000;
+    std::size_t threads = std::thread::hardware_concurrency();
+    std::uint32_t seed = 281;
+};  // Options
+
+
+enum TaskClass : std::size_t { Urgent, Normal, Long, NumClasses };
+
+const char *const kClassNames[NumClasses] = { "urgent", "normal", "long" };
+
+
+struct TaskSpec {
+    TaskClass kind;
+    int priority;
+    std::uint32_t work;  // iterations of busy work
+};  // TaskSpec
+
+
+// Keeps the optimizer from discarding the busy work.
+std::atomic<std::uint64_t> sink { 0 };
+
+
+Options parseOptions(int argc, char *argv[]) {
+    Options options;
+    const option longOptions[] = {
+        { "tasks", required_argument, nullptr, 'n' },
+        { "threads", required_argument, nullptr, 't' },
+        { "seed", required_argument, nullptr, 's' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 },
+    };
+
+    int choice = 0;
+    while ((choice = getopt_long(argc, argv, "n:t:s:h", longOptions, nullptr)) != -1) {
+        switch (choice) {
+        case 'n':
+            options.tasks = std::stoul(optarg);
+            break;
+        case 't':
+            options.threads = std::stoul(optarg);
+            break;
+        case 's':
+            options.seed = static_cast<std::uint32_t>(std::stoul(optarg));
+            break;
+        case 'h':
+            std::cout << "Usage: " << argv[0] << " [-n tasks] [-t threads] [-s seed]\n";
+            std::exit(0);
+        default:
+            std::cerr << "Unknown option, try --help\n";
+            std::exit(1);
+        }  // switch
+    }  // while
+
+    if (options.threads == 0) options.threads = 1;
+    return options;
+}  // parseOptions()
+
+
+std::vector<TaskSpec> makeTasks(std::size_t count, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> normalPriority(1, 8);
+    std::vector<TaskSpec> tasks(count);
+    for (TaskSpec &task : tasks) {
+        const int roll = percent(rng);
+        if (roll < 20) {
+            task = { Urgent, 10, 200 };
+        } else if (roll < 90) {
+            task = { Normal, normalPriority(rng), 200 };
+        } else {
+            task = { Long, 0, 20000 };
+        }  // if
+    }  // for ..task
+    return tasks;
+}  // makeTasks()
+
+
+// CPU-bound work whose cost scales with 'iterations'.
+void busyWork(std::uint32_t iterations) {
+    std::uint64_t x = iterations;
+    for (std::uint32_t i = 0; i < iterations; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }  // for ..i
+    sink.fetch_add(x, std::memory_order_relaxed);
+}  // busyWork()
+
+
+double percentile(std::vector<double> &values, double fraction) {
+    if (values.empty()) return 0.0;
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return values[index];
+}  // percentile()
+
+
+void printHeader() {
+    std::cout << std::left << std::setw(16) << "engine" << std::setw(10) << "scenario"
+              << std::right << std::setw(12) << "tasks/s" << std::setw(8) << "steals";
+    for (const char *name : kClassNames) {
+        std::cout << std::setw(11) << (std::string(name) + " p50")
+                  << std::setw(11) << (std::string(name) + " p99");
+    }  // for ..name
+    std::cout << "\n" << std::setw(46) << "" << "(latency in microseconds)\n";
+}  // printHeader()
+
+
+// Run every task in 'tasks' through a PriorityExecutor<PQ> and report.
+template <template <typename...> typename PQ>
+void benchEngine(const char *engine, const std::vector<TaskSpec> &tasks, const Options &options,
+                 bool spawned) {
+    std::vector<double> latency(tasks.size());
+    PriorityExecutor<PQ> executor { options.threads };
+
+    auto postAll = [&executor, &tasks, &latency] {
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            const TaskSpec spec = tasks[i];
+            const Clock::time_point posted = Clock::now();
+            executor.post(spec.priority, [spec, posted, i, &latency] {
+                latency[i] = std::chrono::duration<double, std::micro>(Clock::now() - posted).count();
+                busyWork(spec.work);
+            });
+        }  // for ..i
+    };
+
+    const Clock::time_point start = Clock::now();
+    if (spawned) {
+        executor.post(100, postAll);
+    } else {
+        postAll();
+    }  // if
+    executor.waitIdle();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> byClass[NumClasses];
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        byClass[tasks[i].kind].push_back(latency[i]);
+    }  // for ..i
+
+    std::cout << std::left << std::setw(16) << engine << std::setw(10)
+              << (spawned ? "spawned" : "external") << std::right << std::fixed
+              << std::setprecision(0) << std::setw(12) << static_cast<double>(tasks.size()) / seconds
+              << std::setw(8) << executor.stealCount() << std::setprecision(1);
+    for (std::vector<double> &values : byClass) {
+        std::cout << std::setw(11) << percentile(values, 0.5) << std::setw(11)
+                  << percentile(values, 0.99);
+    }  // for ..values
+    std::cout << '\n';
+}  // benchEngine()
+
+}  // namespace
+
+
+int main(int argc, char *argv[]) {
+    std::ios_base::sync_with_stdio(false);
+    const Options options = parseOptions(argc, argv);
+    std::mt19937 rng { options.seed };
+    const std::vector<TaskSpec> tasks = makeTasks(options.tasks, rng);
+
+    std::cout << "tasks = " << options.tasks << ", threads = " << options.threads
+              << ", seed = " << options.seed << "\n\n";
+    printHeader();
+    for (bool spawned : { false, true }) {
+        benchEngine<BinaryPQ>("Binary", tasks, options, spawned);
+        benchEngine<PairingPQ>("Pairing", tasks, options, spawned);
+        benchEngine<CompactPairingPQ>("CompactPairing", tasks, options, spawned);
+        benchEngine<RankPairingPQ>("RankPairing", tasks, options, spawned);
+    }  // for ..spawned
+
+    return 0;
+}  // main()
@@ -0,0 +1,529 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Application benchmark: Dijkstra, Prim and A* over synthetic graphs, run
+ * with every priority queue.
+ *
+ * Graphs are generated locally from a seed:
+ *   grid       - square 4-neighbour grid, integer weights in [1, 10]
+ *   geometric  - random geometric graph in the unit square, average degree
+ *                about 8, Euclidean edge weights
+ *   powerlaw   - Barabasi-Albert preferential attachment (4 edges per new
+ *                vertex), integer weights in [1, 100]
+ *
+ * BinaryPQ, SortedPQ, UnorderedPQ, UnorderedFastPQ and PersistentPQ run the
+ * lazy-deletion versions (push a new entry on every improvement, skip stale
+ * entries on pop). PairingPQ, CompactPairingPQ and RankPairingPQ run the
+ * decrease-key versions (one node per vertex via addNode, improvements via
+ * updateElt). A* needs coordinates,
+ * so it is skipped on the power-law graph.
+ *
+ * Each run is done twice: once with NullInstrument for the end-to-end time,
+ * and once with CountingInstrument for the comparison count. Peak memory is
+ * the peak number of PQ entries times the bytes each one costs (the element
+ * for vector-backed queues, the whole node for node-based ones).
+ *
+ * Usage: ./benchGraph [-n vertices] [-s seed] [-l linear-limit]
+ *   -n, --vertices      vertices per graph (default 100000)
+ *   -s, --seed          random seed (default 281)
+ *   -l, --linear-limit  largest graph to run the O(n)-per-operation queues
+ *                       (SortedPQ, UnorderedPQ, UnorderedFastPQ) on
+ *                       (default 20000)
+ *
+ * Build with 'make bench' (release flags).
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BinaryPQ.hpp"
+#include "CompactPairingPQ.hpp"
+#include "PQInstrument.hpp"
+#include "PairingPQ.hpp"
+#include "PersistentPQ.hpp"
+#include "RankPairingPQ.hpp"
+#include "SortedPQ.hpp"
+#include "UnorderedFastPQ.hpp"
+#include "UnorderedPQ.hpp"
+
+namespace {
+
+using Vertex = std::uint32_t;
+
+const double kInfinity = std::numeric_limits<double>::infinity();
+
+
+struct Options {
+    std::size_t vertices = 100000;
+    std::uint32_t seed = 281;
+    std::size_t linearLimit = 20000;
+};  // Options
+
+
+// A weighted undirected graph in compressed sparse row form. Coordinates
+// are only present for graphs with a geometric embedding (used by A*).
+struct Graph {
+    std::string name;
+    std::vector<std::size_t> offsets;  // edges of v are [offsets[v], offsets[v + 1])
+    std::vector<Vertex> targets;
+    std::vector<double> weights;
+    std::vector<std::pair<double, double>> coords;
+    bool manhattan = false;  // heuristic: Manhattan (grid) or Euclidean
+
+    [[nodiscard]] std::size_t size() const { return offsets.size() - 1; }
+};  // Graph
+
+
+struct Edge {
+    Vertex from;
+    Vertex to;
+    double weight;
+};  // Edge
+
+
+Graph buildGraph(std::string name, std::size_t n, const std::vector<Edge> &edges) {
+    Graph graph;
+    graph.name = std::move(name);
+    graph.offsets.assign(n + 1, 0);
+    for (const Edge &edge : edges) {
+        ++graph.offsets[edge.from + 1];
+        ++graph.offsets[edge.to + 1];
+    }  // for ..edge
+    for (std::size_t v = 0; v < n; ++v) {
+        graph.offsets[v + 1] += graph.offsets[v];
+    }  // for ..v
+
+    graph.targets.resize(graph.offsets[n]);
+    graph.weights.resize(graph.offsets[n]);
+    std::vector<std::size_t> fill(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const Edge &edge : edges) {
+        graph.targets[fill[edge.from]] = edge.to;
+        graph.weights[fill[edge.from]++] = edge.weight;
+        graph.targets[fill[edge.to]] = edge.from;
+        graph.weights[fill[edge.to]++] = edge.weight;
+    }  // for ..edge
+    return graph;
+}  // buildGraph()
+
+
+Graph makeGrid(std::size_t n, std::mt19937 &rng) {
+    const auto side = static_cast<std::size_t>(std::sqrt(static_cast<double>(n)));
+    std::uniform_int_distribution<int> weight(1, 10);
+    std::vector<Edge> edges;
+    for (std::size_t y = 0; y < side; ++y) {
+        for (std::size_t x = 0; x < side; ++x) {
+            const auto v = static_cast<Vertex>(y * side + x);
+            if (x + 1 < side) edges.push_back({ v, v + 1, static_cast<double>(weight(rng)) });
+            if (y + 1 < side) edges.push_back({ v, static_cast<Vertex>(v + side), static_cast<double>(weight(rng)) });
+        }  // for ..x
+    }  // for ..y
+
+    Graph graph = buildGraph("grid", side * side, edges);
+    graph.manhattan = true;
+    for (std::size_t v = 0; v < side * side; ++v) {
+        graph.coords.emplace_back(static_cast<double>(v % side), static_cast<double>(v / side));
+    }  // for ..v
+    return graph;
+}  // makeGrid()
+
+
+Graph makeGeometric(std::size_t n, std::mt19937 &rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<std::pair<double, double>> points(n);
+    for (auto &point : points) {
+        point = { unit(rng), unit(rng) };
+    }  // for ..point
+
+    // Radius for an expected degree of about 8; bucket points into cells
+    // of that size so only neighbouring cells have to be checked.
+    const double radius = std::sqrt(8.0 / (M_PI * static_cast<double>(n)));
+    const auto cells = std::max<std::size_t>(1, static_cast<std::size_t>(1.0 / radius));
+    auto cellOf = [cells](double c) {
+        return std::min(cells - 1, static_cast<std::size_t>(c * static_cast<double>(cells)));
+    };
+    std::vector<std::vector<Vertex>> grid(cells * cells);
+    for (std::size_t v = 0; v < n; ++v) {
+        grid[cellOf(points[v].second) * cells + cellOf(points[v].first)].push_back(
+            static_cast<Vertex>(v));
+    }  // for ..v
+
+    std::vector<Edge> edges;
+    for (std::size_t v = 0; v < n; ++v) {
+        const std::size_t cx = cellOf(points[v].first);
+        const std::size_t cy = cellOf(points[v].second);
+        for (std::size_t y = cy ? cy - 1 : 0; y <= std::min(cells - 1, cy + 1); ++y) {
+            for (std::size_t x = cx ? cx - 1 : 0; x <= std::min(cells - 1, cx + 1); ++x) {
+                for (Vertex u : grid[y * cells + x]) {
+                    if (u <= v) continue;
+                    const double dx = points[u].first - points[v].first;
+                    const double dy = points[u].second - points[v].second;
+                    const double dist = std::sqrt(dx * dx + dy * dy);
+                    if (dist <= radius) edges.push_back({ static_cast<Vertex>(v), u, dist });
+                }  // for ..u
+            }  // for ..x
+        }  // for ..y
+    }  // for ..v
+
+    Graph graph = buildGraph("geometric", n, edges);
+    graph.coords = std::move(points);
+    return graph;
+}  // makeGeometric()
+
+
+Graph makePowerLaw(std::size_t n, std::mt19937 &rng) {
+    const std::size_t perVertex = 4;
+    std::uniform_int_distribution<int> weight(1, 100);
+    std::vector<Edge> edges;
+    // Every edge endpoint, so picking uniformly from it is picking a
+    // vertex with probability proportional to its degree.
+    std::vector<Vertex> endpoints;
+
+    for (Vertex v = 1; v <= perVertex && v < n; ++v) {
+        for (Vertex u = 0; u < v; ++u) {
+            edges.push_back({ u, v, static_cast<double>(weight(rng)) });
+            endpoints.push_back(u);
+            endpoints.push_back(v);
+        }  // for ..u
+    }  // for ..v
+
+    for (std::size_t v = perVertex + 1; v < n; ++v) {
+        for (std::size_t k = 0; k < perVertex; ++k) {
+            std::uniform_int_distribution<std::size_t> pick(0, endpoints.size() - 1);
+            const Vertex u = endpoints[pick(rng)];
+            edges.push_back({ u, static_cast<Vertex>(v), static_cast<double>(weight(rng)) });
+            endpoints.push_back(u);
+            endpoints.push_back(static_cast<Vertex>(v));
+        }  // for ..k
+    }  // for ..v
+
+    return buildGraph("powerlaw", n, edges);
+}  // makePowerLaw()
+
+
+double heuristic(const Graph &graph, Vertex v, Vertex target) {
+    const double dx = std::abs(graph.coords[v].first - graph.coords[target].first);
+    const double dy = std::abs(graph.coords[v].second - graph.coords[target].second);
+    return graph.manhattan ? dx + dy : std::sqrt(dx * dx + dy * dy);
+}  // heuristic()
+
+
+// PQ element: a priority key and the vertex it belongs to.
+struct Entry {
+    double key;
+    Vertex vertex;
+};  // Entry
+
+// Smaller keys are more extreme, turning the max-PQs into min-PQs.
+struct EntryGreater {
+    bool operator()(const Entry &a, const Entry &b) const {
+        return a.key > b.key;
+    }  // operator()()
+};  // EntryGreater
+
+
+enum class Algorithm { Dijkstra, Prim, AStar };
+
+const char *algorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+    case Algorithm::Dijkstra:
+        return "dijkstra";
+    case Algorithm::Prim:
+        return "prim";
+    case Algorithm::AStar:
+        return "astar";
+    }  // switch
+
+    return "unknown";
+}  // algorithmName()
+
+
+// What one run of an algorithm did, independent of timing.
+struct RunStats {
+    double result = 0.0;  // sum of distances, MST weight or path length
+    std::uint64_t pushes = 0;
+    std::uint64_t pops = 0;
+    std::uint64_t stale = 0;  // lazy deletion: popped entries already settled
+    std::uint64_t updates = 0;  // decrease-key: successful updateElt calls
+    std::size_t peak = 0;  // peak number of entries in the PQ
+    std::uint64_t compares = 0;  // only filled in by CountingInstrument runs
+};  // RunStats
+
+
+std::uint64_t comparesOf(const NullInstrument &) { return 0; }
+std::uint64_t comparesOf(const CountingInstrument &stats) { return stats.compareCount(); }
+
+
+// Priority of reaching 'to' over an edge of weight 'weight' from a
+// vertex whose distance/cost is 'base'.
+double priorityOf(Algorithm algorithm, const Graph &graph, double base, double weight, Vertex to,
+                  Vertex target) {
+    switch (algorithm) {
+    case Algorithm::Dijkstra:
+        return base + weight;
+    case Algorithm::Prim:
+        return weight;
+    case Algorithm::AStar:
+        return base + weight + heuristic(graph, to, target);
+    }  // switch
+
+    return kInfinity;
+}  // priorityOf()
+
+
+// Lazy-deletion version: works with any Eecs281PQ of Entry.
+template <typename PQ>
+RunStats runLazy(Algorithm algorithm, const Graph &graph, Vertex source, Vertex target) {
+    const std::size_t n = graph.size();
+    std::vector<double> best(n, kInfinity);  // distance, or key for Prim
+    std::vector<bool> done(n, false);
+    RunStats stats;
+    PQ pq;
+
+    best[source] = 0.0;
+    pq.push({ algorithm == Algorithm::AStar ? heuristic(graph, source, target) : 0.0, source });
+    ++stats.pushes;
+
+    while (!pq.empty()) {
+        const Entry entry = pq.top();
+        pq.pop();
+        ++stats.pops;
+        if (done[entry.vertex]) {
+            ++stats.stale;
+            continue;
+        }  // if
+        done[entry.vertex] = true;
+        const Vertex v = entry.vertex;
+        stats.result += best[v];
+        if (algorithm == Algorithm::AStar && v == target) break;
+
+        for (std::size_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            const Vertex to = graph.targets[e];
+            if (done[to]) continue;
+            const double candidate = algorithm == Algorithm::Prim
+                ? graph.weights[e] : best[v] + graph.weights[e];
+            if (candidate >= best[to]) continue;
+
+            best[to] = candidate;
+            pq.push({ priorityOf(algorithm, graph, best[v], graph.weights[e], to, target), to });
+            ++stats.pushes;
+            stats.peak = std::max(stats.peak, pq.size());
+        }  // for ..e
+    }  // while
+
+    if (algorithm == Algorithm::AStar) stats.result = best[target];
+    stats.compares = comparesOf(pq.instrumentation());
+    return stats;
+}  // runLazy()
+
+
+// Decrease-key version: one node per vertex, improvements via updateElt.
+template <typename PQ>
+RunStats runDecreaseKey(Algorithm algorithm, const Graph &graph, Vertex source, Vertex target) {
+    const std::size_t n = graph.size();
+    std::vector<double> best(n, kInfinity);
+    std::vector<bool> done(n, false);
+    RunStats stats;
+    PQ pq;
+    // Node* for the pointer-based heaps, an index for CompactPairingPQ.
+    using Handle = decltype(pq.addNode(std::declval<Entry>()));
+    std::vector<Handle> handles(n);
+    std::vector<bool> queued(n, false);
+
+    best[source] = 0.0;
+    handles[source]
+        = pq.addNode({ algorithm == Algorithm::AStar ? heuristic(graph, source, target) : 0.0, source });
+    queued[source] = true;
+    ++stats.pushes;
+
+    while (!pq.empty()) {
+        const Vertex v = pq.top().vertex;
+        pq.pop();
+        ++stats.pops;
+        done[v] = true;
+        queued[v] = false;  // the node is gone
+        stats.result += best[v];
+        if (algorithm == Algorithm::AStar && v == target) break;
+
+        for (std::size_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            const Vertex to = graph.targets[e];
+            if (done[to]) continue;
+            const double candidate = algorithm == Algorithm::Prim
+                ? graph.weights[e] : best[v] + graph.weights[e];
+            if (candidate >= best[to]) continue;
+
+            best[to] = candidate;
+            const Entry entry { priorityOf(algorithm, graph, best[v], graph.weights[e], to, target), to };
+            if (queued[to]) {
+                pq.updateElt(handles[to], entry);
+                ++stats.updates;
+            } else {
+                handles[to] = pq.addNode(entry);
+                queued[to] = true;
+                ++stats.pushes;
+                stats.peak = std::max(stats.peak, pq.size());
+            }  // if
+        }  // for ..e
+    }  // while
+
+    if (algorithm == Algorithm::AStar) stats.result = best[target];
+    stats.compares = comparesOf(pq.instrumentation());
+    return stats;
+}  // runDecreaseKey()
+
+
+template <template <typename...> typename PQ, bool DECREASE_KEY>
+struct Runner {
+    template <typename INSTRUMENT>
+    using Queue = PQ<Entry, EntryGreater, INSTRUMENT>;
+
+    template <typename INSTRUMENT>
+    static RunStats run(Algorithm algorithm, const Graph &graph, Vertex source, Vertex target) {
+        if constexpr (DECREASE_KEY) {
+            return runDecreaseKey<Queue<INSTRUMENT>>(algorithm, graph, source, target);
+        } else {
+            return runLazy<Queue<INSTRUMENT>>(algorithm, graph, source, target);
+        }  // if
+    }  // run()
+
+    // Bytes one PQ entry costs.
+    static std::size_t entryBytes() {
+        if constexpr (DECREASE_KEY) {
+            return sizeof(typename Queue<NullInstrument>::Node);
+        } else {
+            return sizeof(Entry);
+        }  // if
+    }  // entryBytes()
+};  // Runner
+
+
+void printHeader() {
+    std::cout << std::left << std::setw(11) << "graph" << std::setw(10) << "algo"
+              << std::setw(15) << "pq" << std::right << std::setw(11) << "ms"
+              << std::setw(11) << "pushes" << std::setw(11) << "pops"
+              << std::setw(10) << "stale" << std::setw(10) << "updates"
+              << std::setw(13) << "compares" << std::setw(10) << "peak"
+              << std::setw(10) << "peakKB" << std::setw(16) << "result" << '\n';
+}  // printHeader()
+
+
+template <template <typename...> typename PQ, bool DECREASE_KEY>
+void benchOne(const char *pqName, Algorithm algorithm, const Graph &graph, Vertex source,
+              Vertex target) {
+    using R = Runner<PQ, DECREASE_KEY>;
+
+    const auto start = std::chrono::steady_clock::now();
+    const RunStats stats = R::template run<NullInstrument>(algorithm, graph, source, target);
+    const auto stop = std::chrono::steady_clock::now();
+    const double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+
+    // Second, instrumented run for the comparison count.
+    const std::uint64_t compares
+        = R::template run<CountingInstrument>(algorithm, graph, source, target).compares;
+
+    std::cout << std::left << std::setw(11) << graph.name << std::setw(10)
+              << algorithmName(algorithm) << std::setw(15) << pqName << std::right
+              << std::fixed << std::setprecision(2) << std::setw(11) << ms
+              << std::setw(11) << stats.pushes << std::setw(11) << stats.pops
+              << std::setw(10) << stats.stale << std::setw(10) << stats.updates
+              << std::setw(13) << compares << std::setw(10) << stats.peak
+              << std::setw(10) << stats.peak * R::entryBytes() / 1024
+              << std::setw(16) << std::setprecision(4) << stats.result << '\n';
+}  // benchOne()
+
+
+Options parseOptions(int argc, char *argv[]) {
+    Options options;
+    const option longOptions[] = {
+        { "vertices", required_argument, nullptr, 'n' },
+        { "seed", required_argument, nullptr, 's' },
+        { "linear-limit", required_argument, nullptr, 'l' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 },
+    };
+
+    int choice = 0;
+    while ((choice = getopt_long(argc, argv, "n:s:l:h", longOptions, nullptr)) != -1) {
+        switch (choice) {
+        case 'n':
+            options.vertices = std::max<std::size_t>(16, std::stoul(optarg));
+            break;
+        case 's':
+            options.seed = static_cast<std::uint32_t>(std::stoul(optarg));
+            break;
+        case 'l':
+            options.linearLimit = std::stoul(optarg);
+            break;
+        case 'h':
+            std::cout << "Usage: " << argv[0] << " [-n vertices] [-s seed] [-l linear-limit]\n";
+            std::exit(0);
+        default:
+            std::cerr << "Unknown option, try --help\n";
+            std::exit(1);
+        }  // switch
+    }  // while
+
+    return options;
+}  // parseOptions()
+
+
+void benchGraph(const Graph &graph, const Options &options, std::mt19937 &rng) {
+    const Vertex source = 0;
+    std::uniform_int_distribution<Vertex> pick(0, static_cast<Vertex>(graph.size() - 1));
+    const Vertex target = graph.manhattan ? static_cast<Vertex>(graph.size() - 1) : pick(rng);
+    const bool linear = graph.size() <= options.linearLimit;
+
+    for (Algorithm algorithm : { Algorithm::Dijkstra, Algorithm::Prim, Algorithm::AStar }) {
+        if (algorithm == Algorithm::AStar && graph.coords.empty()) continue;
+
+        benchOne<BinaryPQ, false>("Binary/lazy", algorithm, graph, source, target);
+        if (linear) {
+            benchOne<SortedPQ, false>("Sorted/lazy", algorithm, graph, source, target);
+            benchOne<UnorderedPQ, false>("Unordered/lazy", algorithm, graph, source, target);
+            benchOne<UnorderedFastPQ, false>("UFast/lazy", algorithm, graph, source, target);
+        }  // if
+        benchOne<PersistentPQ, false>("Persist/lazy", algorithm, graph, source, target);
+        benchOne<PairingPQ, true>("Pairing/dk", algorithm, graph, source, target);
+        benchOne<CompactPairingPQ, true>("Compact/dk", algorithm, graph, source, target);
+        benchOne<RankPairingPQ, true>("RankPair/dk", algorithm, graph, source, target);
+    }  // for ..algorithm
+
+    if (!linear) {
+        std::cout << "(" << graph.name << ": skipped the O(n)-per-op queues above "
+                  << options.linearLimit << " vertices; raise --linear-limit to run them)\n";
+    }  // if
+}  // benchGraph()
+
+}  // namespace
+
+
+int main(int argc, char *argv[]) {
+    std::ios_base::sync_with_stdio(false);
+    const Options options = parseOptions(argc, argv);
+    std::mt19937 rng { options.seed };
+
+    const std::vector<std::function<Graph(std::size_t, std::mt19937 &)>> generators {
+        makeGrid, makeGeometric, makePowerLaw,
+    };
+
+    std::cout << "vertices = " << options.vertices << ", seed = " << options.seed << "\n\n";
+    printHeader();
+    for (const auto &generate : generators) {
+        const Graph graph = generate(options.vertices, rng);
+        benchGraph(graph, options, rng);
+    }  // for ..generate
+
+    return 0;
+}  // main()
@@ -0,0 +1,716 @@
+// Project identifier: 43DE0E0C4C76BFAA6D8C2F5AEAE0518A9C42CF4E
+
+/*
+ * Microbenchmark driver for the priority queue implementations.
+ *
+ * Every implementation runs the same three workload phases over the same
+ * pre-generated random keys:
+ *   push   - push every key into an empty PQ
+ *   mixed  - for every key, push it, then top() and pop() (steady state)
+ *   pop    - top() and pop() until the PQ is empty
+ *
+ * The handle-based heaps (PairingPQ, CompactPairingPQ, RankPairingPQ,
+ * IntrusivePairingPQ) also run a decrease-key storm: addNode every key,
+ * updateElt a random node once per key, then drain.
+ *
+ * With -S it instead compares SmallPQ with BinaryPQ and SortedPQ as short
+ * lived queues of N = 8..128 elements: each round builds a fresh queue,
+ * fills it to N, runs N pop/push steps at capacity, and drains it.
+ *
+ * With -M it instead times a k-way merge of sorted runs (10 * size elements
+ * in all, k = 8..4096) through LoserTree's mergeRuns, and through a
+ * BinaryPQ of (head, run) pairs advanced with replace_top().
+ *
+ * With -F it instead compares BinaryPQ's branch-free sift kernel with the
+ * generic one at 1K, 1M and 100M ints: build from a range (heapify), then
+ * up to a million replace_top() and pop() calls. Run with -p as well to see
+ * the branch misses.
+ *
+ * With -L it instead runs large queues, 1M to 100M ints, well past the last
+ * level cache: SequenceHeapPQ against BinaryPQ and a plain 4-ary heap, and
+ * BinaryPQ again with its vector in huge pages (pmr::BinaryPQ over a
+ * HugePageResource). Each size pushes every key, then times up to a million
+ * push/pop steps and a million pops.
+ *
+ * With -B it instead runs the planner's batch phases: four rounds of
+ * inserting 50 * size keys and extracting the best tenth of them, through
+ * BatchParallelPQ on one thread and on every hardware thread, and through
+ * BinaryPQ one element at a time.
+ *
+ * Usage: ./benchPQ [-n size] [-s seed] [-p] [-S] [-M] [-F] [-L] [-B]
+ *   -n, --size     number of keys (default 20000; UnorderedPQ is O(n) per pop)
+ *   -s, --seed     random seed (default 281)
+ *   -p, --profile  also read hardware counters (cycles, instructions, L1d,
+ *                  LLC, branch and dTLB misses) around every phase and
+ *                  report them per operation
+ *   -S, --small    run the small-queue comparison instead
+ *   -M, --merge    run the k-way merge comparison instead
+ *   -F, --sift     run the sift kernel comparison instead (needs about 1.2GB)
+ *   -L, --large    run the large-queue comparison instead (needs about 1.5GB)
+ *   -B, --batch    run the batch insert/extract comparison instead
+ *
+ * Build with 'make bench' (release flags).
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "AdaptivePQ.hpp"
+#include "BatchParallelPQ.hpp"
+#include "BinaryPQ.hpp"
+#include "CompactPairingPQ.hpp"
+#include "HugePageResource.hpp"
+#include "IntrusivePairingPQ.hpp"
+#include "LoserTree.hpp"
+#include "PairingPQ.hpp"
+#include "PerfCounters.hpp"
+#include "PersistentPQ.hpp"
+#include "RankPairingPQ.hpp"
+#include "SequenceHeapPQ.hpp"
+#include "SmallPQ.hpp"
+#include "SortedPQ.hpp"
+#include "UnorderedFastPQ.hpp"
+#include "UnorderedPQ.hpp"
+
+namespace {
+
+struct Options {
+    std::size_t size = 20000;
+    std::uint32_t seed = 281;
+    bool profile = false;
+    bool small = false;
+    bool merge = false;
+    bool sift = false;
+    bool large = false;
+    bool batch = false;
+};  // Options
+
+
+// Results of one timed workload phase.
+struct PhaseResult {
+    const char *phase;
+    std::size_t ops;
+    double nanoseconds;
+    PerfCounters::Reading counters;
+};  // PhaseResult
+
+
+// Keeps the optimizer from discarding the work we are timing.
+volatile std::int64_t sink = 0;
+
+
+Options parseOptions(int argc, char *argv[]) {
+    Options options;
+    const option longOptions[] = {
+        { "size", required_argument, nullptr, 'n' },
+        { "seed", required_argument, nullptr, 's' },
+        { "profile", no_argument, nullptr, 'p' },
+        { "small", no_argument, nullptr, 'S' },
+        { "merge", no_argument, nullptr, 'M' },
+        { "sift", no_argument, nullptr, 'F' },
+        { "large", no_argument, nullptr, 'L' },
+        { "batch", no_argument, nullptr, 'B' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 },
+    };
+
+    int choice = 0;
+    while ((choice = getopt_long(argc, argv, "n:s:pSMFLBh", longOptions, nullptr)) != -1) {
+        switch (choice) {
+        case 'n':
+            options.size = std::stoul(optarg);
+            break;
+        case 's':
+            options.seed = static_cast<std::uint32_t>(std::stoul(optarg));
+            break;
+        case 'p':
+            options.profile = true;
+            break;
+        case 'S':
+            options.small = true;
+            break;
+        case 'M':
+            options.merge = true;
+            break;
+        case 'F':
+            options.sift = true;
+            break;
+        case 'L':
+            options.large = true;
+            break;
+        case 'B':
+            options.batch = true;
+            break;
+        case 'h':
+            std::cout << "Usage: " << argv[0] << " [-n size] [-s seed] [-p] [-S] [-M] [-F] [-L] [-B]\n";
+            std::exit(0);
+        default:
+            std::cerr << "Unknown option, try --help\n";
+            std::exit(1);
+        }  // switch
+    }  // while
+
+    return options;
+}  // parseOptions()
+
+
+// Time (and optionally profile) one phase of 'ops' operations.
+template <typename Body>
+PhaseResult measure(const char *phase, std::size_t ops, PerfCounters *counters, Body body) {
+    PhaseResult result { phase, ops, 0.0, {} };
+
+    if (counters) counters->start();
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto stop = std::chrono::steady_clock::now();
+    if (counters) result.counters = counters->stop();
+
+    result.nanoseconds = std::chrono::duration<double, std::nano>(stop - start).count();
+    return result;
+}  // measure()
+
+
+void printHeader(bool profile) {
+    std::cout << std::left << std::setw(16) << "impl" << std::setw(8) << "phase"
+              << std::right << std::setw(12) << "ns/op";
+    if (profile) {
+        std::cout << std::setw(12) << "cycles/op" << std::setw(12) << "instr/op"
+                  << std::setw(8) << "IPC" << std::setw(12) << "L1d/op"
+                  << std::setw(12) << "LLC/op" << std::setw(12) << "brmiss/op"
+                  << std::setw(12) << "dTLB/op";
+    }  // if
+    std::cout << '\n';
+}  // printHeader()
+
+
+void printPerOp(const PhaseResult &result, PerfCounters::Event event) {
+    if (!result.counters.valid[event]) {
+        std::cout << std::setw(12) << "n/a";
+        return;
+    }  // if
+    std::cout << std::setw(12)
+              << result.counters.values[event] / static_cast<double>(result.ops);
+}  // printPerOp()
+
+
+void printResult(const char *impl, const PhaseResult &result, bool profile) {
+    const double ops = static_cast<double>(result.ops);
+    std::cout << std::left << std::setw(16) << impl << std::setw(8) << result.phase
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << result.nanoseconds / ops;
+
+    if (profile) {
+        printPerOp(result, PerfCounters::Cycles);
+        printPerOp(result, PerfCounters::Instructions);
+        if (result.counters.valid[PerfCounters::Cycles]
+            && result.counters.valid[PerfCounters::Instructions]) {
+            std::cout << std::setw(8)
+                      << result.counters.values[PerfCounters::Instructions]
+                             / result.counters.values[PerfCounters::Cycles];
+        } else {
+            std::cout << std::setw(8) << "n/a";
+        }  // if
+        printPerOp(result, PerfCounters::L1DMisses);
+        printPerOp(result, PerfCounters::LLCMisses);
+        printPerOp(result, PerfCounters::BranchMisses);
+        printPerOp(result, PerfCounters::DTLBMisses);
+    }  // if
+    std::cout << '\n';
+}  // printResult()
+
+
+// Run the push, mixed and pop phases for one PQ implementation.
+template <template <typename...> typename PQ>
+void benchWorkload(const char *impl, const std::vector<int> &keys, PerfCounters *counters,
+                   bool profile) {
+    PQ<int> pq;
+    const std::size_t n = keys.size();
+
+    printResult(impl, measure("push", n, counters, [&]() {
+        for (int key : keys) {
+            pq.push(key);
+        }  // for ..key
+    }), profile);
+
+    printResult(impl, measure("mixed", 2 * n, counters, [&]() {
+        std::int64_t sum = 0;
+        for (int key : keys) {
+            pq.push(key);
+            sum += pq.top();
+            pq.pop();
+        }  // for ..key
+        sink = sink + sum;
+    }), profile);
+
+    printResult(impl, measure("pop", n, counters, [&]() {
+        std::int64_t sum = 0;
+        while (!pq.empty()) {
+            sum += pq.top();
+            pq.pop();
+        }  // while
+        sink = sink + sum;
+    }), profile);
+}  // benchWorkload()
+
+
+// Run the decrease-key storm for a PQ with the addNode/updateElt API.
+template <template <typename...> typename PQ>
+void benchDecreaseKey(const char *impl, const std::vector<int> &keys, PerfCounters *counters,
+                      bool profile) {
+    PQ<int> pq;
+    const std::size_t n = keys.size();
+    // Node* for the pointer-based heaps, an index for CompactPairingPQ.
+    using Handle = decltype(pq.addNode(0));
+    std::vector<Handle> handles;
+    handles.reserve(n);
+    auto eltOf = [&pq](Handle handle) {
+        if constexpr (std::is_pointer<Handle>::value) {
+            return handle->getElt();
+        } else {
+            return pq.getElt(handle);
+        }  // if
+    };
+
+    printResult(impl, measure("addNode", n, counters, [&]() {
+        for (int key : keys) {
+            handles.push_back(pq.addNode(key / 2));
+        }  // for ..key
+    }), profile);
+
+    printResult(impl, measure("update", n, counters, [&]() {
+        for (std::size_t i = 0; i < n; ++i) {
+            // keys[i] is uniform, so this raises a random node by a small
+            // random amount (small enough that repeated hits can't overflow).
+            const Handle handle = handles[static_cast<std::size_t>(keys[i]) % n];
+            pq.updateElt(handle, eltOf(handle) + keys[(i + 1) % n] % 1024 + 1);
+        }  // for ..i
+    }), profile);
+
+    printResult(impl, measure("pop", n, counters, [&]() {
+        std::int64_t sum = 0;
+        while (!pq.empty()) {
+            sum += pq.top();
+            pq.pop();
+        }  // while
+        sink = sink + sum;
+    }), profile);
+}  // benchDecreaseKey()
+
+
+// An element that embeds its own heap links, for IntrusivePairingPQ.
+struct Item {
+    int key;
+    PairingHook<Item> hook;
+};  // Item
+
+struct ItemLess {
+    bool operator()(const Item &a, const Item &b) const { return a.key < b.key; }
+};  // ItemLess
+
+
+// The same decrease-key storm over caller-owned Items: no allocation in the
+// PQ, and updateElt takes the already-updated object.
+void benchIntrusiveDecreaseKey(const char *impl, const std::vector<int> &keys,
+                               PerfCounters *counters, bool profile) {
+    const std::size_t n = keys.size();
+    std::vector<Item> items(n);
+    IntrusivePairingPQ<Item, &Item::hook, ItemLess> pq;
+
+    printResult(impl, measure("addNode", n, counters, [&]() {
+        for (std::size_t i = 0; i < n; ++i) {
+            items[i].key = keys[i] / 2;
+            pq.push(&items[i]);
+        }  // for ..i
+    }), profile);
+
+    printResult(impl, measure("update", n, counters, [&]() {
+        for (std::size_t i = 0; i < n; ++i) {
+            Item &item = items[static_cast<std::size_t>(keys[i]) % n];
+            item.key += keys[(i + 1) % n] % 1024 + 1;
+            pq.updateElt(&item);
+        }  // for ..i
+    }), profile);
+
+    printResult(impl, measure("pop", n, counters, [&]() {
+        std::int64_t sum = 0;
+        while (!pq.empty()) {
+            sum += pq.top()->key;
+            pq.pop();
+        }  // while
+        sink = sink + sum;
+    }), profile);
+}  // benchIntrusiveDecreaseKey()
+
+
+// Run rounds of short-lived QUEUEs holding up to 'capacity' elements, the
+// way per-request candidate lists are used.
+template <typename QUEUE>
+void benchSmallQueue(const char *impl, const char *phase, std::size_t capacity,
+                     const std::vector<int> &keys, PerfCounters *counters, bool profile) {
+    const std::size_t rounds = std::max<std::size_t>(1, 10 * keys.size() / capacity);
+    std::size_t next = 0;
+    auto nextKey = [&keys, &next]() {
+        const int key = keys[next];
+        next = next + 1 == keys.size() ? 0 : next + 1;
+        return key;
+    };
+
+    printResult(impl, measure(phase, rounds * 4 * capacity, counters, [&]() {
+        std::int64_t sum = 0;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            QUEUE pq;
+            for (std::size_t i = 0; i < capacity; ++i) {
+                pq.push(nextKey());
+            }  // for ..i
+            for (std::size_t i = 0; i < capacity; ++i) {
+                sum += pq.top();
+                pq.pop();
+                pq.push(nextKey());
+            }  // for ..i
+            while (!pq.empty()) {
+                sum += pq.top();
+                pq.pop();
+            }  // while
+        }  // for ..round
+        sink = sink + sum;
+    }), profile);
+}  // benchSmallQueue()
+
+
+template <std::size_t N>
+void benchSmall(const std::vector<int> &keys, PerfCounters *counters, bool profile) {
+    const std::string phase = "N=" + std::to_string(N);
+    benchSmallQueue<SmallPQ<int, N>>("Small", phase.c_str(), N, keys, counters, profile);
+    benchSmallQueue<BinaryPQ<int>>("Binary", phase.c_str(), N, keys, counters, profile);
+    benchSmallQueue<SortedPQ<int>>("Sorted", phase.c_str(), N, keys, counters, profile);
+    std::cout << '\n';
+}  // benchSmall()
+
+
+// Merge k sorted runs cut from 'keys', both ways.
+void benchMerge(std::size_t k, const std::vector<int> &keys, PerfCounters *counters,
+                bool profile) {
+    using Iterator = std::vector<int>::const_iterator;
+    std::vector<std::vector<int>> runs(k);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        runs[i % k].push_back(keys[i]);
+    }  // for ..i
+    std::vector<std::pair<Iterator, Iterator>> ranges;
+    for (std::vector<int> &run : runs) {
+        std::sort(run.begin(), run.end());
+        ranges.emplace_back(run.cbegin(), run.cend());
+    }  // for ..run
+
+    const std::string phase = "k=" + std::to_string(k);
+    std::vector<int> out(keys.size());
+    printResult("LoserTree", measure(phase.c_str(), keys.size(), counters, [&]() {
+        mergeRuns(ranges, out.begin());
+        sink = sink + out.back();
+    }), profile);
+
+    // The smallest head on top: (head, run) pairs compared in reverse.
+    using Head = std::pair<int, std::size_t>;
+    printResult("Binary", measure(phase.c_str(), keys.size(), counters, [&]() {
+        BinaryPQ<Head, std::greater<Head>> heads;
+        std::vector<std::pair<Iterator, Iterator>> cursors = ranges;
+        for (std::size_t r = 0; r < k; ++r) {
+            if (cursors[r].first != cursors[r].second) heads.push({ *cursors[r].first, r });
+        }  // for ..r
+        auto next = out.begin();
+        while (!heads.empty()) {
+            const std::size_t r = heads.top().second;
+            *next++ = heads.top().first;
+            if (++cursors[r].first != cursors[r].second) {
+                heads.replace_top({ *cursors[r].first, r });
+            } else {
+                heads.pop();
+            }  // if
+        }  // while
+        sink = sink + out.back();
+    }), profile);
+    std::cout << '\n';
+}  // benchMerge()
+
+
+// An int that BinaryPQ sifts with its generic kernel, for comparison.
+struct GenericInt {
+    int key;
+
+    bool operator<(const GenericInt &other) const { return key < other.key; }
+};  // GenericInt
+
+}  // namespace
+
+template <>
+struct BinaryHeapFastSift<GenericInt> : std::false_type {};
+
+namespace {
+
+// Heapify 'keys', then time replace_top() and pop() on the heap.
+template <typename TYPE>
+void benchSift(const char *impl, const std::vector<TYPE> &keys, PerfCounters *counters,
+               bool profile) {
+    const std::size_t ops = std::min<std::size_t>(keys.size(), 1000000);
+    std::unique_ptr<BinaryPQ<TYPE>> pq;
+    printResult(impl, measure("heapify", keys.size(), counters, [&]() {
+        pq = std::make_unique<BinaryPQ<TYPE>>(keys.begin(), keys.end());
+    }), profile);
+
+    printResult(impl, measure("replace", ops, counters, [&]() {
+        for (std::size_t i = 0; i < ops; ++i) {
+            pq->replace_top(keys[i]);
+        }  // for ..i
+        sink = sink + pq->size();
+    }), profile);
+
+    printResult(impl, measure("pop", ops, counters, [&]() {
+        for (std::size_t i = 0; i < ops; ++i) {
+            pq->pop();
+        }  // for ..i
+        sink = sink + pq->size();
+    }), profile);
+}  // benchSift()
+
+
+// A plain 4-ary heap of ints, largest on top: half BinaryPQ's depth, and
+// all four children of a node share a cache line.
+template <typename TYPE>
+class QuaternaryHeap {
+public:
+    void push(const TYPE &val) {
+        std::size_t i = data.size();
+        data.push_back(val);
+        while (i > 0 && data[(i - 1) / 4] < val) {
+            data[i] = data[(i - 1) / 4];
+            i = (i - 1) / 4;
+        }  // while
+        data[i] = val;
+    }  // push()
+
+    void pop() {
+        const TYPE val = data.back();
+        data.pop_back();
+        const std::size_t size = data.size();
+        std::size_t i = 0;
+        while (4 * i + 1 < size) {
+            const std::size_t first = 4 * i + 1;
+            const std::size_t last = std::min(first + 4, size);
+            std::size_t best = first;
+            for (std::size_t child = first + 1; child < last; ++child) {
+                if (data[best] < data[child]) best = child;
+            }  // for ..child
+            if (!(val < data[best])) break;
+            data[i] = data[best];
+            i = best;
+        }  // while
+        if (size > 0) data[i] = val;
+    }  // pop()
+
+    const TYPE &top() const { return data.front(); }
+    [[nodiscard]] bool empty() const { return data.empty(); }
+
+private:
+    std::vector<TYPE> data;
+};  // QuaternaryHeap
+
+
+// Push every key, then run push/pop steps and pops on the full queue.
+template <typename QUEUE>
+void benchLarge(const char *impl, const std::vector<int> &keys, PerfCounters *counters,
+                bool profile) {
+    const std::size_t ops = std::min<std::size_t>(keys.size(), 1000000);
+    auto pq = std::make_unique<QUEUE>();
+
+    printResult(impl, measure("push", keys.size(), counters, [&]() {
+        for (int key : keys) {
+            pq->push(key);
+        }  // for ..key
+    }), profile);
+
+    printResult(impl, measure("mixed", 2 * ops, counters, [&]() {
+        std::int64_t sum = 0;
+        for (std::size_t i = 0; i < ops; ++i) {
+            pq->push(keys[i]);
+            sum += pq->top();
+            pq->pop();
+        }  // for ..i
+        sink = sink + sum;
+    }), profile);
+
+    printResult(impl, measure("pop", ops, counters, [&]() {
+        std::int64_t sum = 0;
+        for (std::size_t i = 0; i < ops; ++i) {
+            sum += pq->top();
+            pq->pop();
+        }  // for ..i
+        sink = sink + sum;
+    }), profile);
+}  // benchLarge()
+
+
+// Insert each batch of keys, then take out the best tenth of it, in one
+// call each. A QUEUE without the batch calls runs them one at a time.
+template <typename QUEUE>
+void benchBatch(const char *impl, QUEUE &pq, const std::vector<std::vector<int>> &batches,
+                PerfCounters *counters, bool profile) {
+    constexpr bool batched = std::is_same<QUEUE, BatchParallelPQ<int>>::value;
+    std::size_t inserted = 0;
+    for (const std::vector<int> &batch : batches) {
+        inserted += batch.size();
+    }  // for ..batch
+
+    printResult(impl, measure("batches", inserted + inserted / 10, counters, [&]() {
+        std::int64_t sum = 0;
+        for (const std::vector<int> &batch : batches) {
+            const std::size_t k = batch.size() / 10;
+            if constexpr (batched) {
+                pq.insert_batch(batch.begin(), batch.end());
+                for (int key : pq.extract_top_k(k)) {
+                    sum += key;
+                }  // for ..key
+            } else {
+                for (int key : batch) {
+                    pq.push(key);
+                }  // for ..key
+                for (std::size_t i = 0; i < k; ++i) {
+                    sum += pq.top();
+                    pq.pop();
+                }  // for ..i
+            }  // if
+        }  // for ..batch
+        sink = sink + sum;
+    }), profile);
+}  // benchBatch()
+
+}  // namespace
+
+
+int main(int argc, char *argv[]) {
+    std::ios_base::sync_with_stdio(false);
+    const Options options = parseOptions(argc, argv);
+
+    std::mt19937 rng { options.seed };
+    std::uniform_int_distribution<int> dist;
+    std::vector<int> keys(options.size);
+    for (int &key : keys) {
+        key = dist(rng);
+    }  // for ..key
+
+    PerfCounters counters;
+    PerfCounters *active = nullptr;
+    if (options.profile) {
+        if (counters.available()) {
+            active = &counters;
+        } else {
+            std::cout << "note: hardware counters are unavailable here (perf_event_open "
+                         "failed, e.g. inside a container); reporting wall clock only\n";
+        }  // if
+    }  // if
+
+    std::cout << "n = " << options.size << ", seed = " << options.seed << "\n\n";
+    printHeader(active != nullptr);
+
+    const bool profile = active != nullptr;
+    if (options.small) {
+        benchSmall<8>(keys, active, profile);
+        benchSmall<16>(keys, active, profile);
+        benchSmall<32>(keys, active, profile);
+        benchSmall<64>(keys, active, profile);
+        benchSmall<128>(keys, active, profile);
+        return 0;
+    }  // if
+    if (options.large) {
+        for (std::size_t size : { 1000000, 10000000, 100000000 }) {
+            std::cout << "size " << size << '\n';
+            std::vector<int> ints(size);
+            for (int &key : ints) {
+                key = dist(rng);
+            }  // for ..key
+            benchLarge<SequenceHeapPQ<int>>("SequenceHeap", ints, active, profile);
+            benchLarge<BinaryPQ<int>>("Binary", ints, active, profile);
+            HugePageResource huge;
+            std::pmr::memory_resource *previous = std::pmr::set_default_resource(&huge);
+            benchLarge<pmr::BinaryPQ<int>>("Binary/huge", ints, active, profile);
+            std::pmr::set_default_resource(previous);
+            benchLarge<QuaternaryHeap<int>>("4-ary", ints, active, profile);
+            std::cout << '\n';
+        }  // for ..size
+        return 0;
+    }  // if
+    if (options.batch) {
+        std::vector<std::vector<int>> batches(4, std::vector<int>(50 * options.size));
+        for (std::vector<int> &batch : batches) {
+            for (int &key : batch) {
+                key = dist(rng);
+            }  // for ..key
+        }  // for ..batch
+        const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        BatchParallelPQ<int> single { std::less<int>(), 1 };
+        benchBatch("BatchParallel/1", single, batches, active, profile);
+        BatchParallelPQ<int> parallel { std::less<int>(), hardware };
+        const std::string name = "BatchParallel/" + std::to_string(hardware);
+        benchBatch(name.c_str(), parallel, batches, active, profile);
+        BinaryPQ<int> binary;
+        benchBatch("Binary", binary, batches, active, profile);
+        return 0;
+    }  // if
+    if (options.sift) {
+        for (std::size_t size : { 1000, 1000000, 100000000 }) {
+            std::cout << "size " << size << '\n';
+            std::vector<int> ints(size);
+            for (int &key : ints) {
+                key = dist(rng);
+            }  // for ..key
+            benchSift("Binary/fast", ints, active, profile);
+            std::vector<GenericInt> generic(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                generic[i].key = ints[i];
+            }  // for ..i
+            ints = std::vector<int>();
+            benchSift("Binary/generic", generic, active, profile);
+            std::cout << '\n';
+        }  // for ..size
+        return 0;
+    }  // if
+    if (options.merge) {
+        std::vector<int> many(10 * keys.size());
+        for (int &key : many) {
+            key = dist(rng);
+        }  // for ..key
+        for (std::size_t k : { 8, 64, 512, 4096 }) {
+            benchMerge(k, many, active, profile);
+        }  // for ..k
+        return 0;
+    }  // if
+
+    benchWorkload<UnorderedPQ>("Unordered", keys, active, profile);
+    benchWorkload<UnorderedFastPQ>("UnorderedFast", keys, active, profile);
+    benchWorkload<SortedPQ>("Sorted", keys, active, profile);
+    benchWorkload<BinaryPQ>("Binary", keys, active, profile);
+    benchWorkload<PairingPQ>("Pairing", keys, active, profile);
+    benchWorkload<CompactPairingPQ>("CompactPairing", keys, active, profile);
+    benchWorkload<RankPairingPQ>("RankPairing", keys, active, profile);
+    benchWorkload<PersistentPQ>("Persistent", keys, active, profile);
+    benchWorkload<AdaptivePQ>("Adaptive", keys, active, profile);
+
+    std::cout << '\n';
+    benchDecreaseKey<PairingPQ>("Pairing", keys, active, profile);
+    benchDecreaseKey<CompactPairingPQ>("CompactPairing", keys, active, profile);
+    benchDecreaseKey<RankPairingPQ>("RankPairing", keys, active, profile);
+    benchIntrusiveDecreaseKey("Intrusive", keys, active, profile);
+
+    return 0;
+}  // main()
@@ -24,17 +24,60 @@
  * do.
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
 #include <ostream>
+#include <set>
 #include <stdexcept>
+#include <sstream>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "AdaptivePQ.hpp"
+#include "BatchParallelPQ.hpp"
 #include "BinaryPQ.hpp"
+#include "CompactPairingPQ.hpp"
 #include "Eecs281PQ.hpp"
+#include "FlatCombiningPQ.hpp"
+#include "HugePageResource.hpp"
+#include "IntrusivePairingPQ.hpp"
+#include "LoserTree.hpp"
+#include "MinMaxPQ.hpp"
+#include "PQInstrument.hpp"
 #include "PairingPQ.hpp"
+#include "PersistentPQ.hpp"
+#include "PriorityExecutor.hpp"
+#include "RadixSort.hpp"
+#include "RankPairingPQ.hpp"
+#include "SequenceHeapPQ.hpp"
+#include "SharedMemoryPQ.hpp"
+#include "SmallPQ.hpp"
 #include "SortedPQ.hpp"
+#include "TopK.hpp"
+#include "UnorderedFastPQ.hpp"
 #include "UnorderedPQ.hpp"
 
 // A type for representing priority queue types at runtime
@@ -43,6 +86,13 @@ enum class PQType {
     Sorted,
     Binary,
     Pairing,
+    MinMax,
+    RankPairing,
+    Persistent,
+    CompactPairing,
+    Adaptive,
+    SequenceHeap,
+    BatchParallel,
 };
 
 // These can be pretty-printed :)
@@ -56,6 +106,20 @@ std::ostream &operator<<(std::ostream &ost, PQType pqType) {
         return ost << "Binary";
     case PQType::Pairing:
         return ost << "Pairing";
+    case PQType::MinMax:
+        return ost << "MinMax";
+    case PQType::RankPairing:
+        return ost << "RankPairing";
+    case PQType::Persistent:
+        return ost << "Persistent";
+    case PQType::CompactPairing:
+        return ost << "CompactPairing";
+    case PQType::Adaptive:
+        return ost << "Adaptive";
+    case PQType::SequenceHeap:
+        return ost << "SequenceHeap";
+    case PQType::BatchParallel:
+        return ost << "BatchParallel";
     } // switch
 
     return ost << "Unknown PQType";
@@ -70,6 +134,14 @@ struct IntPtrComp {
 }; // IntPtrComp structure
 
 
+// Extracts the int an int const* points to, for KeyCompare
+struct IntPtrKey {
+    int operator()(const int *p) const {
+        return *p;
+    } // operator()
+}; // IntPtrKey structure
+
+
 // Test the primitive operations on a priority queue:
 // constructor, push, pop, top, size, empty.
 template <template <typename...> typename PQ>
@@ -190,6 +262,1440 @@ void testUpdatePriorities() {
     std::cout << "Expanded testUpdatePriorities() succeeded!" << std::endl;
 }
 
+// Test that an instrumented PQ behaves the same and that its counters and
+// latency histograms see every operation.
+template <template <typename...> typename PQ>
+void testInstrumentation() {
+    std::cout << "Testing instrumentation policy..." << std::endl;
+
+    PQ<int, std::less<int>, CountingInstrument> pq {};
+    const int n = 200;
+    for (int i = 0; i < n; ++i) {
+        pq.push((i * 37) % n);
+    }
+
+    for (int expected = n - 1; expected >= 0; --expected) {
+        assert(pq.top() == expected);
+        pq.pop();
+    }
+    assert(pq.empty());
+
+    [[maybe_unused]] const CountingInstrument &stats = pq.instrumentation();
+    assert(stats.compareCount() > 0);
+    assert(stats.latency(PQOp::Push).count() == static_cast<std::uint64_t>(n));
+    assert(stats.latency(PQOp::Pop).count() == static_cast<std::uint64_t>(n));
+    assert(stats.latency(PQOp::Top).count() == static_cast<std::uint64_t>(n));
+    assert(stats.latency(PQOp::Pop).percentile(50) <= stats.latency(PQOp::Pop).max());
+
+    pq.instrumentation().reset();
+    assert(pq.instrumentation().compareCount() == 0);
+
+    LogHistogram histogram;
+    for (std::uint64_t v = 1; v <= 1000; ++v) {
+        histogram.record(v);
+    }
+    [[maybe_unused]] const std::uint64_t median = histogram.percentile(50);
+    assert(median >= 480 && median <= 500);
+    assert(histogram.min() == 1 && histogram.max() == 1000);
+
+    std::cout << "testInstrumentation succeeded!" << std::endl;
+} // testInstrumentation()
+
+
+// Test replace_top on any PQ that has it: it must match pop() then push().
+template <template <typename...> typename PQ>
+void testReplaceTop() {
+    std::cout << "Testing replace_top..." << std::endl;
+
+    PQ<int> pq {};
+    for (int i = 0; i < 10; ++i) {
+        pq.push(i * 10);
+    }
+
+    pq.replace_top(5);   // removes 90
+    assert(pq.size() == 10);
+    assert(pq.top() == 80);
+    pq.replace_top(100); // removes 80, new top
+    assert(pq.top() == 100);
+
+    std::vector<int> expected { 100, 70, 60, 50, 40, 30, 20, 10, 5, 0 };
+    for ([[maybe_unused]] int val : expected) {
+        assert(pq.top() == val);
+        pq.pop();
+    }
+    assert(pq.empty());
+
+    std::cout << "testReplaceTop succeeded!" << std::endl;
+} // testReplaceTop()
+
+
+// Test save/load on any PQ that has it: a restored PQ must pop the same
+// sequence, and unreadable or corrupted snapshots must throw.
+template <template <typename...> typename PQ>
+void testSnapshot() {
+    std::cout << "Testing save/load..." << std::endl;
+    const std::string path = "project2b_test.snapshot";
+
+    std::vector<int> vec;
+    for (int i = 0; i < 200; ++i) {
+        vec.push_back((i * 37) % 101);
+    }
+    PQ<int> pq { vec.begin(), vec.end() };
+    pq.pop();
+    pq.push(500);
+    pq.save(path);
+
+    PQ<int> restored {};
+    restored.push(-1);
+    restored.load(path);
+    assert(restored.size() == pq.size());
+    while (!pq.empty()) {
+        assert(restored.top() == pq.top());
+        pq.pop();
+        restored.pop();
+    }
+    assert(restored.empty());
+
+    // An empty PQ round-trips too.
+    pq.save(path);
+    restored.push(1);
+    restored.load(path);
+    assert(restored.empty());
+
+    // Any array snapshot can be loaded; a PQ fixes up its own invariant.
+    BinaryPQ<int> heap { vec.begin(), vec.end() };
+    heap.save(path);
+    restored.load(path);
+    assert(restored.size() == vec.size());
+    assert(restored.top() == *std::max_element(vec.begin(), vec.end()));
+
+    // Flip the last payload byte: the checksum must catch it.
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-1, std::ios::end);
+        const char last = static_cast<char>(file.get());
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char>(last ^ 0x5a));
+    }
+    [[maybe_unused]] bool threw = false;
+    try {
+        restored.load(path);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw && restored.empty());
+
+    // A corrupted count must fail as a short payload before anything is
+    // allocated for it, both when it is huge and when it is off by one.
+    const PQ<int> source { vec.begin(), vec.end() };
+    for (const std::uint64_t count : { std::uint64_t { 1 } << 60, std::uint64_t { vec.size() + 1 } }) {
+        source.save(path);
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(static_cast<std::streamoff>(offsetof(SnapshotHeader, count)));
+            file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        }
+        threw = false;
+        try {
+            restored.load(path);
+        } catch (const std::runtime_error &error) {
+            threw = std::string(error.what()).find("truncated payload") != std::string::npos;
+        }
+        assert(threw && restored.empty());
+    }
+
+    std::remove(path.c_str());
+    threw = false;
+    try {
+        restored.load(path);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "testSnapshot succeeded!" << std::endl;
+} // testSnapshot()
+
+
+// Test that PersistentPQ versions are independent: pushing or popping one
+// never changes another, however many nodes they share.
+void testPersistent() {
+    std::cout << "Testing PersistentPQ versions..." << std::endl;
+
+    PersistentPQ<int> empty {};
+    const PersistentPQ<int> one = empty.pushed(5);
+    const PersistentPQ<int> two = one.pushed(9);
+    const PersistentPQ<int> three = two.pushed(7);
+    assert(empty.empty() && one.size() == 1 && two.size() == 2 && three.size() == 3);
+    assert(one.top() == 5 && two.top() == 9 && three.top() == 9);
+
+    const PersistentPQ<int> popped = three.popped();
+    assert(popped.top() == 7 && three.top() == 9 && three.size() == 3);
+
+    // A snapshot taken mid-stream keeps its contents while the original
+    // keeps changing.
+    PersistentPQ<int> producer {};
+    for (int i = 0; i < 100; ++i) {
+        producer.push(i);
+    }
+    const PersistentPQ<int> snapshot = producer;
+    for (int i = 0; i < 50; ++i) {
+        producer.pop();
+        producer.push(-i);
+    }
+    assert(producer.top() == 49 && producer.size() == 100);
+    PersistentPQ<int> walker = snapshot;
+    for (int expected = 99; expected >= 0; --expected) {
+        assert(walker.top() == expected);
+        walker.pop();
+    }
+    assert(walker.empty() && snapshot.size() == 100);
+
+    // Sorted input builds one long left spine; dropping it must not
+    // recurse once per node.
+    {
+        PersistentPQ<int> chain {};
+        for (int i = 0; i < 200000; ++i) {
+            chain.push(i);
+        }
+        assert(chain.top() == 199999);
+    }
+
+    // Versions sharing nodes are read and dropped on two threads at once:
+    // whichever drops a shared node last frees it, after the other's reads.
+    for (int round = 0; round < 20; ++round) {
+        PersistentPQ<int> base {};
+        for (int i = 0; i < 2000; ++i) {
+            base.push(i);
+        }
+        PersistentPQ<int> left = base.popped();
+        PersistentPQ<int> right = base.pushed(-1);
+        base = PersistentPQ<int> {};
+        auto readAndDrop = [](PersistentPQ<int> version) {
+            std::size_t popped = 0;
+            for (PersistentPQ<int> walker = version; !walker.empty() && popped < 100; ++popped) {
+                walker.pop();
+            }
+            version = PersistentPQ<int> {};
+            return popped;
+        };
+        auto other = std::async(std::launch::async, readAndDrop, std::move(left));
+        assert(readAndDrop(std::move(right)) == 100);
+        assert(other.get() == 100);
+    }
+
+    std::cout << "testPersistent succeeded!" << std::endl;
+} // testPersistent()
+
+
+// Test erase_if/invalidate tombstones against a reference multiset: top(),
+// pop() and size() must only ever see live elements, with compaction
+// kicking in at any fraction.
+template <template <typename...> typename PQ>
+void testTombstones() {
+    std::cout << "Testing tombstones..." << std::endl;
+
+    PQ<int> pq {};
+    for (int i = 0; i < 100; ++i) {
+        pq.push(i);
+    }
+    [[maybe_unused]] const std::size_t erased = pq.erase_if([](int val) { return val % 2 == 0; });
+    assert(erased == 50 && pq.size() == 50 && pq.top() == 99);
+    [[maybe_unused]] bool found = pq.invalidate(99);
+    assert(found && pq.top() == 97 && pq.size() == 49);
+    found = pq.invalidate(99);
+    assert(!found);
+    found = pq.invalidate(42);
+    assert(!found);
+    for (int expected = 97; expected > 90; expected -= 2) {
+        assert(pq.top() == expected);
+        pq.pop();
+    }
+    assert(pq.size() == 45);
+
+    // Draining skips the tombstones among the elements it takes.
+    pq.erase_if([](int val) { return val == 85 || val == 11; });
+    std::vector<int> drained;
+    pq.pop_above(80, std::back_inserter(drained));
+    assert((drained == std::vector<int> { 89, 87, 83, 81 }));
+    assert(pq.size() == 39 && pq.top() == 79);
+    drained.clear();
+    pq.drain_while([](int val) { return val > 1; }, std::back_inserter(drained));
+    assert(drained.size() == 38 && drained.back() == 3);
+    assert(pq.size() == 1 && pq.top() == 1);
+
+    std::multiset<int> reference;
+    for (const double fraction : { 0.0, 0.25, 2.0 }) {
+        PQ<int> lazy {};
+        lazy.setCompactionFraction(fraction);
+        reference.clear();
+
+        unsigned state = 42;
+        auto next = [&state]() {
+            state = state * 1103515245u + 12345u;
+            return state >> 8;
+        };
+        for (int round = 0; round < 3000; ++round) {
+            const unsigned op = next() % 10;
+            if (op < 5 || reference.empty()) {
+                const int val = static_cast<int>(next() % 500);
+                lazy.push(val);
+                reference.insert(val);
+            } else if (op < 7) {
+                lazy.pop();
+                reference.erase(std::prev(reference.end()));
+            } else if (op < 9) {
+                const int val = static_cast<int>(next() % 500);
+                const auto it = reference.find(val);
+                [[maybe_unused]] const bool invalidated = lazy.invalidate(val);
+                assert(invalidated == (it != reference.end()));
+                if (it != reference.end()) reference.erase(it);
+            } else {
+                const int mod = static_cast<int>(next() % 50);
+                lazy.erase_if([mod](int val) { return val % 50 == mod; });
+                for (auto it = reference.begin(); it != reference.end();) {
+                    it = *it % 50 == mod ? reference.erase(it) : std::next(it);
+                }
+            }
+            assert(lazy.size() == reference.size());
+            assert(lazy.empty() == reference.empty());
+            assert(reference.empty() || lazy.top() == *reference.rbegin());
+        }
+
+        // Rebuilding and snapshots also see only live elements.
+        lazy.updatePriorities();
+        assert(lazy.size() == reference.size());
+        lazy.erase_if([](int val) { return val < 100; });
+        const std::string path = "project2b_tombstones.snapshot";
+        lazy.save(path);
+        PQ<int> restored {};
+        restored.load(path);
+        std::remove(path.c_str());
+        assert(restored.size() == lazy.size());
+        while (!lazy.empty()) {
+            assert(restored.top() == lazy.top() && lazy.top() >= 100);
+            lazy.pop();
+            restored.pop();
+        }
+    }
+
+    std::cout << "testTombstones succeeded!" << std::endl;
+} // testTombstones()
+
+
+// Test drain_while and pop_above against a multiset: small drains, a drain
+// of most of the PQ (BinaryPQ's rebuild path), and one that takes nothing.
+template <template <typename...> typename PQ>
+void testDrain() {
+    std::cout << "Testing drain_while/pop_above..." << std::endl;
+
+    PQ<int> pq {};
+    std::multiset<int> reference;
+    for (int i = 0; i < 2000; ++i) {
+        const int val = (i * 7919) % 1000;  // every value twice
+        pq.push(val);
+        reference.insert(val);
+    }
+
+    // Drain everything above 'cutoff' and check it against the reference.
+    auto check = [&pq, &reference](int cutoff, [[maybe_unused]] const std::vector<int> &drained) {
+        std::vector<int> expected;
+        while (!reference.empty() && *reference.rbegin() > cutoff) {
+            expected.push_back(*reference.rbegin());
+            reference.erase(std::prev(reference.end()));
+        }
+        assert(drained == expected);
+        assert(pq.size() == reference.size());
+        assert(pq.empty() || pq.top() == *reference.rbegin());
+    };
+
+    std::vector<int> drained;
+    pq.pop_above(995, std::back_inserter(drained));
+    check(995, drained);
+    drained.clear();
+    pq.drain_while([](int val) { return val > 990; }, std::back_inserter(drained));
+    check(990, drained);
+    drained.clear();
+    pq.pop_above(2000, std::back_inserter(drained));
+    check(2000, drained);
+
+    // Most of what is left, then the rest, with pushes in between.
+    drained.clear();
+    pq.pop_above(150, std::back_inserter(drained));
+    check(150, drained);
+    for (int val : { 500, 149, 3 }) {
+        pq.push(val);
+        reference.insert(val);
+    }
+    drained.clear();
+    pq.pop_above(100, std::back_inserter(drained));
+    check(100, drained);
+    drained.clear();
+    pq.drain_while([](int) { return true; }, std::back_inserter(drained));
+    check(-1, drained);
+    assert(pq.empty());
+
+    std::cout << "testDrain succeeded!" << std::endl;
+} // testDrain()
+
+
+// Test markDirty/updateDirty in the IntPtrComp pattern: change a few
+// pointed-to values in either direction, mark just those, and check the PQ
+// pops everything in order, in fewer comparisons than updatePriorities.
+template <template <typename...> typename PQ>
+void testUpdateDirty() {
+    std::cout << "Testing markDirty/updateDirty..." << std::endl;
+
+    unsigned state = 7;
+    auto next = [&state]() {
+        state = state * 1103515245u + 12345u;
+        return state >> 8;
+    };
+
+    for (const std::size_t changes : { std::size_t { 1 }, std::size_t { 10 }, std::size_t { 900 } }) {
+        std::vector<int> values(2000);
+        for (int &val : values) {
+            val = static_cast<int>(next() % 100000);
+        }
+        PQ<const int *, IntPtrComp, CountingInstrument> pq {};
+        for (const int &val : values) {
+            pq.push(&val);
+        }
+        // Cancel every 97th slot, so tombstones have to follow the repairs.
+        const int *base = values.data();
+        auto cancelled = [base](const int *ptr) { return (ptr - base) % 97 == 0; };
+        pq.erase_if(cancelled);
+
+        for (std::size_t c = 0; c < changes; ++c) {
+            int &val = values[next() % values.size()];
+            val = static_cast<int>(next() % 100000);
+            pq.markDirty(&val);
+        }
+        // Compare against a full rebuild of a copy rather than a fixed
+        // budget, as debug-mode standard algorithms add checks of their own.
+        auto rebuilt = pq;
+        rebuilt.instrumentation().reset();
+        rebuilt.updatePriorities();
+        pq.instrumentation().reset();
+        pq.updateDirty();
+        assert(changes > 10
+               || pq.instrumentation().compareCount() < rebuilt.instrumentation().compareCount());
+
+        std::vector<int> expected;
+        for (const int &val : values) {
+            if (!cancelled(&val)) expected.push_back(val);
+        }
+        std::sort(expected.rbegin(), expected.rend());
+        assert(pq.size() == expected.size());
+        for ([[maybe_unused]] int val : expected) {
+            assert(*pq.top() == val);
+            pq.pop();
+        }
+        assert(pq.empty());
+    }
+
+    std::cout << "testUpdateDirty succeeded!" << std::endl;
+} // testUpdateDirty()
+
+
+// Build a SortedPQ<TYPE, COMP> out of 'values' (large enough to take the
+// radix sort path) and check that it pops them in std::sort's order.
+template <typename TYPE, typename COMP>
+void checkRadixOrder(std::vector<TYPE> values) {
+    static_assert(RadixKey<TYPE, COMP>::enabled);
+    assert((values.size() >= radixSortCutoff<TYPE, COMP>));
+    SortedPQ<TYPE, COMP> pq { values.begin(), values.end() };
+    std::sort(values.begin(), values.end(), COMP());
+    assert(pq.size() == values.size());
+    for (auto it = values.rbegin(); it != values.rend(); ++it) {
+        assert(pq.top() == *it);
+        pq.pop();
+    }
+} // checkRadixOrder()
+
+
+// Test the radix sort behind SortedPQ's bulk loads: signed, unsigned and
+// floating keys at their extremes, both orders, keys that need only some
+// of the passes, and a key extractor reloaded through updatePriorities().
+void testRadixSort() {
+    std::cout << "Testing SortedPQ radix sort..." << std::endl;
+
+    static_assert(!RadixKey<const int *, IntPtrComp>::enabled);
+    static_assert(!RadixKey<long double, std::less<long double>>::enabled);
+    static_assert(!RadixKey<int, std::less<long>>::enabled);
+    static_assert(RadixKey<const int *, KeyCompare<IntPtrKey, std::greater<int>>>::enabled);
+
+    unsigned state = 5;
+    auto next = [&state]() {
+        state = state * 1103515245u + 12345u;
+        return state >> 8;
+    };
+
+    std::vector<int> ints;
+    std::vector<double> doubles;
+    std::vector<float> floats;
+    std::vector<long long> longs;
+    std::vector<unsigned char> bytes;
+    for (int i = 0; i < 3000; ++i) {
+        const int r = static_cast<int>(next()) - (1 << 23);
+        ints.push_back(i % 3 == 0 ? r % 100 : r * 97);  // some need one pass
+        doubles.push_back(static_cast<double>(r) / 1024.0);
+        floats.push_back(static_cast<float>(r) * 1e-30f);
+        longs.push_back(static_cast<long long>(r) * 1000003LL);
+        bytes.push_back(static_cast<unsigned char>(r));
+    }
+    ints.insert(ints.end(), { std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 0, -1 });
+    doubles.insert(doubles.end(), { -0.0, 0.0, -std::numeric_limits<double>::infinity(),
+                                    std::numeric_limits<double>::infinity(), std::numeric_limits<double>::lowest(),
+                                    std::numeric_limits<double>::denorm_min() });
+    floats.insert(floats.end(), { -0.0f, std::numeric_limits<float>::max(), -std::numeric_limits<float>::min() });
+    longs.insert(longs.end(), { std::numeric_limits<long long>::min(), std::numeric_limits<long long>::max() });
+
+    checkRadixOrder<int, std::less<int>>(ints);
+    checkRadixOrder<int, std::greater<int>>(ints);
+    checkRadixOrder<unsigned, std::less<>>(std::vector<unsigned>(ints.begin(), ints.end()));
+    checkRadixOrder<double, std::less<double>>(doubles);
+    checkRadixOrder<double, std::greater<>>(doubles);
+    checkRadixOrder<float, std::less<float>>(floats);
+    checkRadixOrder<long long, std::greater<long long>>(longs);
+    checkRadixOrder<unsigned char, std::less<unsigned char>>(bytes);
+
+    // A min-PQ of pointers by the value they point to: change the values,
+    // then reload (twice, through the same scratch buffer).
+    std::vector<int> values(ints.begin(), ints.begin() + 1500);
+    std::vector<const int *> pointers;
+    for (const int &val : values) {
+        pointers.push_back(&val);
+    }
+    using ByValue = KeyCompare<IntPtrKey, std::greater<>>;
+    SortedPQ<const int *, ByValue> pq { pointers.begin(), pointers.end() };
+    for (int round = 0; round < 2; ++round) {
+        for (int &val : values) {
+            val = static_cast<int>(next() % 5000) - 2500;
+        }
+        pq.updatePriorities();
+        std::vector<int> expected(values);
+        std::sort(expected.begin(), expected.end());
+        std::vector<const int *> popped;
+        for ([[maybe_unused]] int val : expected) {
+            assert(*pq.top() == val);
+            popped.push_back(pq.top());
+            pq.pop();
+        }
+        assert(pq.empty());
+        for (const int *p : popped) {
+            pq.push(p);
+        }
+    }
+
+    std::cout << "testRadixSort succeeded!" << std::endl;
+} // testRadixSort()
+
+
+// Test PriorityExecutor over the given engine: priority order on a single
+// worker, then many tasks (some posting more tasks) on several workers.
+template <template <typename...> typename PQ>
+void testPriorityExecutor() {
+    std::cout << "Testing PriorityExecutor..." << std::endl;
+
+    {
+        // Hold the only worker until everything is queued, so the order the
+        // tasks run in is the queue's order.
+        PriorityExecutor<PQ> executor { 1 };
+        std::promise<void> release;
+        std::shared_future<void> gate = release.get_future().share();
+        executor.post(100, [gate] { gate.wait(); });
+
+        std::vector<int> order;
+        for (int priority : { 3, 9, 1, 9, 5 }) {
+            executor.post(priority, [&order, priority] { order.push_back(priority); });
+        }
+        executor.post(9, [&order] { order.push_back(10); });  // ties run FIFO
+        release.set_value();
+        executor.waitIdle();
+        assert((order == std::vector<int> { 9, 9, 10, 5, 3, 1 }));
+    }
+
+    {
+        PriorityExecutor<PQ> executor { 4 };
+        std::atomic<int> count { 0 };
+        for (int i = 0; i < 200; ++i) {
+            executor.post(i % 7, [&executor, &count, i] {
+                ++count;
+                for (int j = 0; j < 4; ++j) {
+                    executor.post(i % 5, [&count] { ++count; });
+                }
+            });
+        }
+        executor.waitIdle();
+        assert(count == 200 * 5);
+
+        std::future<int> answer = executor.submit(1, [] { return 42; });
+        std::future<void> failure = executor.submit(2, [] { throw std::runtime_error("task"); });
+        assert(answer.get() == 42);
+        [[maybe_unused]] bool threw = false;
+        try {
+            failure.get();
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        assert(threw);
+        assert(executor.threadCount() == 4);
+    }
+
+    std::cout << "testPriorityExecutor succeeded!" << std::endl;
+} // testPriorityExecutor()
+
+
+// Test FlatCombiningPQ and LockedPQ over the given engine: order on one
+// thread, then every value accounted for after several threads push and pop
+// at once.
+template <template <typename...> typename PQ>
+void testFlatCombining() {
+    std::cout << "Testing FlatCombiningPQ and LockedPQ..." << std::endl;
+
+    auto check = [](auto &pq) {
+        int out = 0;
+        assert(!pq.tryPop(out) && pq.empty());
+        for (int val : { 4, 8, 1, 6 }) {
+            pq.push(val);
+        }
+        assert(pq.size() == 4);
+        for ([[maybe_unused]] int val : { 8, 6, 4, 1 }) {
+            assert(pq.tryPop(out) && out == val);
+        }
+        assert(!pq.tryPop(out));
+
+        // Each thread pushes its own range and pops after every other push.
+        const int threads = 6;
+        const int perThread = 500;
+        std::vector<std::vector<int>> popped(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&pq, &popped, t] {
+                for (int i = 0; i < perThread; ++i) {
+                    pq.push(t * perThread + i);
+                    int val = 0;
+                    if (i % 2 == 1 && pq.tryPop(val)) popped[t].push_back(val);
+                }
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+
+        std::vector<int> seen;
+        for (const std::vector<int> &mine : popped) {
+            seen.insert(seen.end(), mine.begin(), mine.end());
+        }
+        [[maybe_unused]] int previous = threads * perThread;
+        while (pq.tryPop(out)) {
+            assert(out < previous);  // the rest drain in order
+            previous = out;
+            seen.push_back(out);
+        }
+        std::sort(seen.begin(), seen.end());
+        assert(seen.size() == static_cast<std::size_t>(threads * perThread));
+        for (std::size_t i = 0; i < seen.size(); ++i) {
+            assert(seen[i] == static_cast<int>(i));
+        }
+    };
+
+    FlatCombiningPQ<int, std::less<int>, PQ> combining { std::less<int> {}, 4 };
+    check(combining);
+    assert(combining.combinedCount() >= combining.batchCount());
+    LockedPQ<int, std::less<int>, PQ> locked {};
+    check(locked);
+
+    std::cout << "testFlatCombining succeeded!" << std::endl;
+} // testFlatCombining()
+
+
+// Test BinaryPQ::pushBatch with batches small and large relative to the
+// heap, including one into a heap holding tombstones.
+void testPushBatch() {
+    std::cout << "Testing pushBatch..." << std::endl;
+
+    unsigned state = 3;
+    auto batchOf = [&state](std::size_t count) {
+        std::vector<int> values(count);
+        for (int &val : values) {
+            state = state * 1103515245u + 12345u;
+            val = static_cast<int>((state >> 8) % 5000);
+        }
+        return values;
+    };
+
+    BinaryPQ<int> pq {};
+    std::vector<int> expected;
+    pq.pushBatch(expected.begin(), expected.end());
+    assert(pq.empty());
+
+    // Cancel the multiples of 3 among the first batch; later batches keep
+    // theirs.
+    std::vector<int> first = batchOf(300);
+    pq.pushBatch(first.begin(), first.end());
+    pq.erase_if([](int val) { return val % 3 == 0; });
+    for (int val : first) {
+        if (val % 3 != 0) expected.push_back(val);
+    }
+
+    for (const std::size_t count : { std::size_t { 1 }, std::size_t { 5 }, std::size_t { 40 },
+                                     std::size_t { 1000 } }) {
+        const std::vector<int> values = batchOf(count);
+        pq.pushBatch(values.begin(), values.end());
+        expected.insert(expected.end(), values.begin(), values.end());
+    }
+
+    std::sort(expected.rbegin(), expected.rend());
+    assert(pq.size() == expected.size());
+    for ([[maybe_unused]] int val : expected) {
+        assert(pq.top() == val);
+        pq.pop();
+    }
+
+    std::cout << "testPushBatch succeeded!" << std::endl;
+} // testPushBatch()
+
+
+// A memory resource that counts what passes through it to the default one.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t allocations = 0;
+    std::size_t bytesInUse = 0;
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        bytesInUse += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    } // do_allocate()
+
+    void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override {
+        bytesInUse -= bytes;
+        std::pmr::new_delete_resource()->deallocate(block, bytes, alignment);
+    } // do_deallocate()
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    } // do_is_equal()
+}; // CountingResource
+
+
+// Test one PQ type with a polymorphic allocator: its storage comes from the
+// resource it was given, all of it is returned, and an arena that refuses
+// to grow past its buffer is enough.
+template <template <typename...> typename PQ>
+void testAllocator() {
+    using Allocator = std::pmr::polymorphic_allocator<int>;
+    CountingResource counting;
+    {
+        PQ<int, std::less<int>, NullInstrument, Allocator> pq { std::less<int>(), &counting };
+        for (int i = 0; i < 200; ++i) {
+            pq.push((i * 37) % 200);
+        }
+        assert(counting.allocations > 0);
+        assert(pq.get_allocator().resource() == &counting);
+
+        // A copy uses the default resource, as standard containers do.
+        PQ<int, std::less<int>, NullInstrument, Allocator> copy { pq };
+        assert(copy.get_allocator().resource() == std::pmr::get_default_resource());
+        copy = pq;
+        for (int i = 199; i >= 0; --i) {
+            assert(pq.top() == i);
+            assert(copy.top() == i);
+            pq.pop();
+            copy.pop();
+        }
+    }
+    assert(counting.bytesInUse == 0);
+
+    std::array<unsigned char, 1 << 16> buffer;
+    std::pmr::monotonic_buffer_resource arena { buffer.data(), buffer.size(), std::pmr::null_memory_resource() };
+    std::vector<int> keys { 5, 1, 4, 2, 3 };
+    PQ<int, std::greater<int>, NullInstrument, Allocator> ascending { keys.begin(), keys.end(), std::greater<int>(), &arena };
+    for (int i = 1; i <= 5; ++i) {
+        assert(ascending.top() == i);
+        ascending.pop();
+    }
+} // testAllocator()
+
+
+// Test the allocator-aware PQs and HugePageResource.
+void testAllocators() {
+    std::cout << "Testing allocators..." << std::endl;
+
+    testAllocator<UnorderedPQ>();
+    testAllocator<UnorderedFastPQ>();
+    testAllocator<SortedPQ>();
+    testAllocator<BinaryPQ>();
+    testAllocator<PairingPQ>();
+
+    // Past 2 MB the heap's vector is mapped by the resource itself, with
+    // reserved or transparent huge pages; nothing is left with upstream.
+    CountingResource upstream;
+    HugePageResource huge { &upstream };
+    {
+        pmr::BinaryPQ<int> pq { std::less<int>(), &huge };
+        const int n = 600000;
+        for (int i = 0; i < n; ++i) {
+            pq.push(static_cast<int>(static_cast<long long>(i) * 7919 % n));
+        }
+#ifdef __linux__
+        assert(huge.hugeTlbBlocks() + huge.transparentBlocks() > 0);
+#endif
+        for (int i = n - 1; i >= n - 1000; --i) {
+            assert(pq.top() == i);
+            pq.pop();
+        }
+    }
+    assert(upstream.bytesInUse == 0);
+
+    std::cout << "testAllocators succeeded!" << std::endl;
+} // testAllocators()
+
+
+// Test SharedMemoryPQ within one process, then across a fork(): the child
+// blocks in pop() until the parent pushes.
+void testSharedMemory() {
+#ifdef __linux__
+    std::cout << "Testing SharedMemoryPQ..." << std::endl;
+
+    const std::string name = "/pq281-test-" + std::to_string(getpid());
+    SharedMemoryPQ<int>::unlink(name);
+    {
+        auto pq = SharedMemoryPQ<int>::create(name, 8);
+        assert(pq.capacity() == 8 && pq.empty());
+        int out = 0;
+        [[maybe_unused]] bool popped = pq.tryPop(out);
+        assert(!popped);
+        for (int val : { 5, 1, 9, 3, 7, 2, 8, 6 }) {
+            pq.push(val);
+        }
+        [[maybe_unused]] const bool pushed = pq.tryPush(4);
+        assert(pq.size() == 8 && !pushed);
+        [[maybe_unused]] bool threw = false;
+        try {
+            pq.push(4);
+        } catch (const std::length_error &) {
+            threw = true;
+        }
+        assert(threw);
+        for ([[maybe_unused]] int val : { 9, 8, 7, 6, 5, 3, 2, 1 }) {
+            popped = pq.tryPop(out);
+            assert(popped && out == val);
+        }
+        popped = pq.popFor(out, std::chrono::milliseconds(5));
+        assert(!popped);
+
+        // A second mapping of the same segment sees the same heap.
+        auto other = SharedMemoryPQ<int>::open(name);
+        pq.push(42);
+        assert(other.size() == 1);
+        out = other.pop();
+        assert(out == 42 && pq.empty());
+
+        threw = false;
+        try {
+            SharedMemoryPQ<int>::create(name, 8);
+        } catch (const std::system_error &) {
+            threw = true;
+        }
+        assert(threw);
+
+        const int count = 50;
+        const pid_t child = fork();
+        if (child == 0) {
+            // Child: take 'count' elements, blocking while there are none.
+            auto queue = SharedMemoryPQ<int>::open(name);
+            int sum = 0;
+            for (int i = 0; i < count; ++i) {
+                sum += queue.pop();
+            }
+            _exit(sum == count * (count + 1) / 2 ? 0 : 1);
+        }
+        assert(child > 0);
+        for (int i = 1; i <= count; ++i) {
+            if (i % 10 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            while (!pq.tryPush(i)) std::this_thread::yield();
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        assert(pq.empty());
+
+        // Two poppers asleep, plus one killed in its sleep: two quick
+        // pushes (the second possibly onto a non-empty PQ) must reach both.
+        pid_t sleepers[3];
+        for (pid_t &sleeper : sleepers) {
+            sleeper = fork();
+            if (sleeper == 0) {
+                auto queue = SharedMemoryPQ<int>::open(name);
+                _exit(queue.pop() > 0 ? 0 : 1);
+            }
+            assert(sleeper > 0);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        kill(sleepers[2], SIGKILL);
+        waitpid(sleepers[2], &status, 0);
+        pq.push(1);
+        pq.push(2);
+        for (int i = 0; i < 2; ++i) {
+            waitpid(sleepers[i], &status, 0);
+            assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+        assert(pq.empty());
+    }
+    [[maybe_unused]] bool unlinked = SharedMemoryPQ<int>::unlink(name);
+    assert(unlinked);
+
+    // A segment whose capacity claims more than it holds is rejected, even
+    // when capacity * sizeof(TYPE) wraps around to something small.
+    {
+        const std::uint64_t capacity = 4099;
+        SharedMemoryPQ<int>::create(name, capacity);
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+        assert(fd >= 0);
+        void *mapping = mmap(nullptr, 64, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        assert(mapping != MAP_FAILED);
+        close(fd);
+        auto *words = static_cast<std::uint64_t *>(mapping);
+        std::uint64_t *field = std::find(words, words + 8, capacity);
+        assert(field != words + 8);
+        *field = (std::uint64_t { 1 } << 62) + 1;
+        munmap(mapping, 64);
+        [[maybe_unused]] bool threw = false;
+        try {
+            SharedMemoryPQ<int>::open(name);
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        assert(threw);
+        unlinked = SharedMemoryPQ<int>::unlink(name);
+        assert(unlinked);
+    }
+
+    std::cout << "testSharedMemory succeeded!" << std::endl;
+#endif
+} // testSharedMemory()
+
+
+// Test AdaptivePQ: forced migrations between every pair of engines keep
+// the contents, and push-heavy, pop-heavy and balanced phases each settle
+// on the engine they should, with the pop order checked throughout.
+void testAdaptive() {
+    std::cout << "Testing AdaptivePQ..." << std::endl;
+
+    const AdaptiveEngine engines[] = { AdaptiveEngine::Unordered, AdaptiveEngine::Sorted,
+                                       AdaptiveEngine::Binary };
+    for (AdaptiveEngine from : engines) {
+        for (AdaptiveEngine to : engines) {
+            AdaptivePQ<int> pq {};
+            pq.setAdaptive(false);
+            pq.migrateTo(from);
+            for (int val : { 4, 9, 1, 7, 3, 8 }) {
+                pq.push(val);
+            }
+            pq.migrateTo(to);
+            assert(pq.engine() == to && pq.size() == 6);
+            for ([[maybe_unused]] int val : { 9, 8, 7, 4, 3, 1 }) {
+                assert(pq.top() == val);
+                pq.pop();
+            }
+        }
+    }
+
+    AdaptivePQ<int, std::less<int>, CountingInstrument> pq {};
+    pq.setWindow(64);
+    std::multiset<int> reference;
+    unsigned state = 5;
+    auto next = [&state]() {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>((state >> 8) % 100000);
+    };
+    auto push = [&](int val) {
+        pq.push(val);
+        reference.insert(val);
+    };
+    auto pop = [&]() {
+        assert(pq.top() == *reference.rbegin());
+        pq.pop();
+        reference.erase(std::prev(reference.end()));
+    };
+
+    // Push-only: a bulk load. (Even one pop per hundred pushes is enough
+    // for the heap to win at this size.)
+    for (int i = 0; i < 5000; ++i) {
+        push(next());
+    }
+    assert(pq.engine() == AdaptiveEngine::Unordered);
+
+    // Pop-heavy after the bulk load.
+    for (int i = 0; i < 2000; ++i) {
+        pop();
+    }
+    assert(pq.engine() == AdaptiveEngine::Sorted);
+
+    // Balanced: one push per pop, which should settle on the heap and stay.
+    for (int i = 0; i < 1000; ++i) {
+        push(next());
+        pop();
+    }
+    assert(pq.engine() == AdaptiveEngine::Binary);
+    [[maybe_unused]] const std::size_t settled = pq.migrationCount();
+    for (int i = 0; i < 3000; ++i) {
+        push(next());
+        pop();
+    }
+    assert(pq.engine() == AdaptiveEngine::Binary && pq.migrationCount() == settled);
+
+    // The counts carried over every migration.
+    assert(pq.instrumentation().compareCount() > 0);
+    while (!reference.empty()) {
+        pop();
+    }
+    assert(pq.empty());
+
+    std::cout << "testAdaptive succeeded!" << std::endl;
+} // testAdaptive()
+
+
+// Whether a SmallPQ filled with 'input' pops 'expected', at compile time.
+template <std::size_t N, typename COMP = std::less<int>>
+constexpr bool smallDrainsTo(std::array<int, N> input, std::array<int, N> expected) {
+    SmallPQ<int, N, COMP> pq { input.begin(), input.end() };
+    for (int val : expected) {
+        if (pq.top() != val) return false;
+        pq.pop();
+    }
+    return pq.empty();
+} // smallDrainsTo()
+
+static_assert(smallDrainsTo<6>({ 4, 1, 6, 1, 9, 0 }, { 9, 6, 4, 1, 1, 0 }));
+static_assert(smallDrainsTo<4, std::greater<int>>({ 3, -2, 7, 3 }, { -2, 3, 3, 7 }));
+
+
+// Test SmallPQ against SortedPQ, with a branch-free element type and one
+// that takes the shifting path.
+void testSmallPQ() {
+    std::cout << "Testing SmallPQ..." << std::endl;
+
+    SmallPQ<int, 16> pq {};
+    SortedPQ<int> reference {};
+    assert(pq.empty() && pq.capacity() == 16);
+    for (int i = 0; i < 400; ++i) {
+        const int val = (i * 7919) % 23;
+        if (pq.full() || (i % 3 == 2 && !pq.empty())) {
+            assert(pq.top() == reference.top());
+            pq.pop();
+            reference.pop();
+        } else {
+            pq.push(val);
+            reference.push(val);
+        }
+        assert(pq.size() == reference.size());
+    }
+    assert(not pq.full() || not pq.tryPush(0));
+
+    SmallPQ<int, 2> tiny {};
+    assert(tiny.tryPush(1) && tiny.tryPush(2) && !tiny.tryPush(3));
+    [[maybe_unused]] bool threw = false;
+    try {
+        tiny.push(3);
+    } catch (const std::length_error &) {
+        threw = true;
+    }
+    assert(threw && tiny.size() == 2 && tiny.top() == 2);
+    tiny.clear();
+    assert(tiny.empty());
+
+    const std::vector<std::string> words { "pear", "fig", "apple", "kiwi", "date" };
+    SmallPQ<std::string, 8, std::greater<std::string>> strings { words.begin(), words.end() };
+    std::string previous;
+    while (!strings.empty()) {
+        assert(previous <= strings.top());
+        previous = strings.top();
+        strings.pop();
+    }
+    assert(previous == "pear");
+
+    std::cout << "testSmallPQ succeeded!" << std::endl;
+} // testSmallPQ()
+
+
+// An int that BinaryPQ sifts with its generic kernel.
+struct SlowSiftInt {
+    int key;
+
+    bool operator<(const SlowSiftInt &other) const { return key < other.key; }
+}; // SlowSiftInt
+
+template <>
+struct BinaryHeapFastSift<SlowSiftInt> : std::false_type {};
+
+
+// Test that BinaryPQ's branch-free sift agrees with the generic one, with
+// fewer comparisons, and that tombstones still work on top of it.
+void testFastSift() {
+    std::cout << "Testing BinaryPQ fast sift..." << std::endl;
+
+    static_assert(BinaryHeapFastSift<int>::value && BinaryHeapFastSift<double>::value);
+    static_assert(not BinaryHeapFastSift<std::string>::value);
+
+    std::vector<int> keys;
+    std::vector<SlowSiftInt> slowKeys;
+    for (int i = 0; i < 3000; ++i) {
+        keys.push_back((i * 7919) % 1009);
+        slowKeys.push_back({ keys.back() });
+    }
+    BinaryPQ<int, std::less<int>, CountingInstrument> fast { keys.begin(), keys.end() };
+    BinaryPQ<SlowSiftInt, std::less<SlowSiftInt>, CountingInstrument> slow { slowKeys.begin(),
+                                                                            slowKeys.end() };
+    fast.instrumentation().reset();
+    slow.instrumentation().reset();
+    for (int i = 0; i < 1000; ++i) {
+        assert(fast.top() == slow.top().key);
+        fast.replace_top(i % 500);
+        slow.replace_top({ i % 500 });
+    }
+    while (!fast.empty()) {
+        assert(fast.top() == slow.top().key);
+        fast.pop();
+        slow.pop();
+    }
+    assert(slow.empty());
+    assert(fast.instrumentation().compareCount() < slow.instrumentation().compareCount());
+
+    // Tombstones switch the heap to the generic sift until they are gone.
+    BinaryPQ<int> mixed { keys.begin(), keys.end() };
+    mixed.erase_if([](int val) { return val % 3 == 0; });
+    [[maybe_unused]] int previous = mixed.top();
+    while (!mixed.empty()) {
+        assert(mixed.top() <= previous && mixed.top() % 3 != 0);
+        previous = mixed.top();
+        mixed.pop();
+    }
+
+    // Rebuilding a heap with no children to sift into: empty and single.
+    std::vector<int> none;
+    BinaryPQ<int> empty { none.begin(), none.end() };
+    empty.updatePriorities();
+    assert(empty.empty());
+    BinaryPQ<int> single {};
+    single.push(42);
+    single.updatePriorities();
+    assert(single.size() == 1 && single.top() == 42);
+
+    std::cout << "testFastSift succeeded!" << std::endl;
+} // testFastSift()
+
+
+// Test SequenceHeapPQ past several insertion-heap flushes and a group
+// merge, against a multiset, including elements that have to displace part
+// of the deletion buffer.
+void testSequenceHeap() {
+    std::cout << "Testing SequenceHeapPQ..." << std::endl;
+
+    SequenceHeapPQ<int> pq {};
+    std::multiset<int> reference;
+    unsigned state = 281;
+    auto next = [&state]() {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>((state >> 8) % 100000);
+    };
+
+    // Enough pushes for 64 flushed sequences to merge into group 1.
+    for (int i = 0; i < 34000; ++i) {
+        const int val = next();
+        pq.push(val);
+        reference.insert(val);
+    }
+    // Pops drain the deletion buffer while pushes keep arriving, some of
+    // them more extreme than what the buffer holds.
+    for (int i = 0; i < 15000; ++i) {
+        if (i % 3 == 0) {
+            const int val = next() + (i % 2 == 0 ? 100000 : 0);
+            pq.push(val);
+            reference.insert(val);
+        } else {
+            assert(pq.top() == *reference.rbegin());
+            pq.pop();
+            reference.erase(std::prev(reference.end()));
+        }
+        assert(pq.size() == reference.size());
+    }
+
+    std::vector<int> keys(reference.begin(), reference.end());
+    std::reverse(keys.begin(), keys.end());
+    SequenceHeapPQ<int, std::greater<int>> ascending { keys.begin(), keys.end() };
+    for (auto it = reference.begin(); it != reference.end(); ++it) {
+        assert(ascending.top() == *it);
+        ascending.pop();
+    }
+    assert(ascending.empty());
+
+    while (!pq.empty()) {
+        assert(pq.top() == *reference.rbegin());
+        pq.pop();
+        reference.erase(std::prev(reference.end()));
+    }
+
+    std::cout << "testSequenceHeap succeeded!" << std::endl;
+} // testSequenceHeap()
+
+
+// Test BatchParallelPQ's batch operations against a multiset, and that the
+// order of extraction, down to equal keys, doesn't depend on the thread
+// count. Batches are big enough to be split between threads.
+void testBatchParallel() {
+    std::cout << "Testing BatchParallelPQ..." << std::endl;
+
+    // Equal keys are told apart by id, which the comparator ignores.
+    using Item = std::pair<int, int>;
+    struct KeyLess {
+        bool operator()(const Item &a, const Item &b) const {
+            return a.first < b.first;
+        } // operator()()
+    }; // KeyLess
+
+    auto run = [](std::size_t threads) {
+        BatchParallelPQ<Item, KeyLess> pq { KeyLess {}, threads };
+        std::multiset<int> reference;
+        std::vector<Item> extracted;
+        unsigned state = 281;
+        int id = 0;
+        // The first 'high' keys of the batch beat everything else.
+        auto insert = [&](int n, int high) {
+            std::vector<Item> batch;
+            for (int i = 0; i < n; ++i) {
+                state = state * 1103515245u + 12345u;
+                batch.emplace_back(static_cast<int>((state >> 8) % 5000) + (i < high ? 5000 : 0), id++);
+                reference.insert(batch.back().first);
+            }
+            pq.insert_batch(batch.begin(), batch.end());
+        };
+        auto extract = [&](std::size_t k) {
+            const std::vector<Item> top = pq.extract_top_k(k);
+            assert(top.size() == std::min(k, top.size() + pq.size()));
+            for (const Item &item : top) {
+                assert(item.first == *reference.rbegin());
+                reference.erase(std::prev(reference.end()));
+                extracted.push_back(item);
+            }
+            assert(pq.size() == reference.size());
+        };
+
+        insert(70000, 0);
+        extract(9000);
+        insert(40000, 0);
+        insert(300, 0);
+        pq.push(Item { 4999, id++ });
+        reference.insert(4999);
+        extract(20000);
+        assert(pq.top().first == *reference.rbegin());
+        pq.pop();
+        reference.erase(std::prev(reference.end()));
+        // Most of the next extraction sits in one partition, which has to
+        // give more than its share.
+        insert(35000, 1500);
+        extract(3000);
+        extract(1000000);
+        assert(pq.empty());
+        return extracted;
+    };
+
+    const std::vector<Item> expected = run(1);
+    for ([[maybe_unused]] std::size_t threads : { 2, 3, 8 }) {
+        assert(run(threads) == expected);
+    }
+
+    std::cout << "testBatchParallel succeeded!" << std::endl;
+} // testBatchParallel()
+
+
+// Test BinaryPQ::pushpop and the TopK selector built on top of BinaryPQ.
+void testTopK() {
+    std::cout << "Testing pushpop and TopK..." << std::endl;
+
+    BinaryPQ<int> binary {};
+    assert(binary.pushpop(7) == 7);  // empty: handed straight back
+    binary.push(3);
+    binary.push(9);
+    assert(binary.pushpop(10) == 10);
+    assert(binary.pushpop(4) == 9);
+    assert(binary.size() == 2 && binary.top() == 4);
+
+    TopK<int> best { 5 };
+    for (int i = 0; i < 100; ++i) {
+        best.push((i * 37) % 100);
+    }
+    assert(best.full());
+    assert(best.worst() == 95);
+    assert(not best.push(10));  // early reject
+
+    const std::vector<int> kept = best.extract();
+    assert((kept == std::vector<int> { 99, 98, 97, 96, 95 }));
+    assert(best.empty());
+
+    TopK<int, std::greater<int>> smallest { 3 };
+    for (int val : { 5, 1, 8, 3, 2, 9 }) {
+        smallest.push(val);
+    }
+    assert((smallest.extract() == std::vector<int> { 1, 2, 3 }));
+
+    TopK<int> none { 0 };
+    assert(not none.push(1));
+    assert(none.empty());
+
+    std::cout << "testTopK succeeded!" << std::endl;
+} // testTopK()
+
+
+// Test the loser tree directly and through mergeRuns: order, stability,
+// empty and single runs, and at most ceil(log k) comparisons per element.
+void testLoserTree() {
+    std::cout << "Testing LoserTree..." << std::endl;
+
+    LoserTree<int> tree { 5 };
+    tree.prime(0, 4);
+    tree.prime(2, 9);
+    tree.prime(3, 7);
+    tree.build();
+    assert(tree.top() == 9 && tree.topSource() == 2);
+    tree.replace_top(1);
+    assert(tree.top() == 7 && tree.topSource() == 3);
+    tree.exhaust_top();
+    assert(tree.top() == 4);
+    tree.exhaust_top();
+    assert(tree.top() == 1 && tree.topSource() == 2);
+    tree.exhaust_top();
+    assert(tree.empty() && tree.sources() == 5);
+
+    // Runs of (key, run) pairs ordered by key alone, with plenty of ties.
+    using Item = std::pair<int, int>;
+    const std::size_t k = 37;
+    std::vector<std::vector<Item>> runs(k);
+    std::vector<Item> expected;
+    for (std::size_t r = 0; r < k; ++r) {
+        const int length = r % 5 == 4 ? 0 : static_cast<int>((r * 13) % 40);
+        for (int i = 0; i < length; ++i) {
+            runs[r].emplace_back(i / 3, static_cast<int>(r));
+        }
+        expected.insert(expected.end(), runs[r].begin(), runs[r].end());
+    }
+    auto byKey = [](const Item &a, const Item &b) { return a.first < b.first; };
+    std::stable_sort(expected.begin(), expected.end(), byKey);
+
+    std::size_t compares = 0;
+    auto counting = [&compares](const Item &a, const Item &b) {
+        ++compares;
+        return a.first < b.first;
+    };
+    std::vector<std::pair<std::vector<Item>::const_iterator, std::vector<Item>::const_iterator>> ranges;
+    for (const std::vector<Item> &run : runs) {
+        ranges.emplace_back(run.begin(), run.end());
+    }
+    std::vector<Item> merged;
+    mergeRuns(ranges, std::back_inserter(merged), counting);
+    assert(merged == expected);  // sorted, and stable across runs
+    std::size_t depth = 0;
+    while ((std::size_t { 1 } << depth) < k) ++depth;
+    assert(compares <= k + merged.size() * depth);
+
+    // Single-pass input and output iterators, and the degenerate cases.
+    std::istringstream first { "1 4 9" };
+    std::istringstream second { "2 3 10 11" };
+    using Stream = std::istream_iterator<int>;
+    std::ostringstream joined;
+    mergeRuns(std::vector<std::pair<Stream, Stream>> { { Stream { first }, Stream {} },
+                                                       { Stream { second }, Stream {} } },
+              std::ostream_iterator<int> { joined, " " });
+    assert(joined.str() == "1 2 3 4 9 10 11 ");
+
+    std::vector<int> out;
+    const std::vector<int> only { 5, 3, 1 };
+    mergeRuns(std::vector<std::pair<std::vector<int>::const_iterator, std::vector<int>::const_iterator>> {
+                  { only.begin(), only.end() } },
+              std::back_inserter(out), std::greater<int> {});
+    assert(out == only);
+    mergeRuns(std::vector<std::pair<int *, int *>> {}, std::back_inserter(out));
+    assert(out.size() == 3);
+
+    // Elements need no default constructor.
+    struct Boxed {
+        explicit Boxed(int val) : val { val } {}
+        bool operator<(const Boxed &other) const { return val < other.val; }
+        int val;
+    }; // Boxed
+    const std::vector<Boxed> odds { Boxed { 1 }, Boxed { 5 } };
+    const std::vector<Boxed> evens { Boxed { 2 }, Boxed { 4 }, Boxed { 6 } };
+    std::vector<Boxed> boxed;
+    mergeRuns(std::vector<std::pair<std::vector<Boxed>::const_iterator, std::vector<Boxed>::const_iterator>> {
+                  { odds.begin(), odds.end() }, { evens.begin(), evens.end() } },
+              std::back_inserter(boxed));
+    const std::vector<int> boxedOrder { 1, 2, 4, 5, 6 };
+    assert(boxed.size() == boxedOrder.size());
+    for (std::size_t i = 0; i < boxed.size(); ++i) {
+        assert(boxed[i].val == boxedOrder[i]);
+    }
+
+    std::cout << "testLoserTree succeeded!" << std::endl;
+} // testLoserTree()
+
+
+// Test both ends of the min-max heap against a sorted reference, plus
+// bounded pushes that evict the least extreme element.
+void testMinMax() {
+    std::cout << "Testing MinMaxPQ double-ended operations..." << std::endl;
+
+    std::vector<int> reference;
+    MinMaxPQ<int> pq {};
+    unsigned state = 12345;
+    for (int round = 0; round < 2000; ++round) {
+        state = state * 1103515245u + 12345u;
+        const int val = static_cast<int>((state >> 16) % 500);
+        const unsigned op = (state >> 8) % 4;
+
+        if (op < 2 || reference.empty()) {
+            pq.push(val);
+            reference.insert(std::upper_bound(reference.begin(), reference.end(), val), val);
+        } else if (op == 2) {
+            assert(pq.top() == reference.back());
+            pq.pop_max();
+            reference.pop_back();
+        } else {
+            assert(pq.bottom() == reference.front());
+            pq.pop_min();
+            reference.erase(reference.begin());
+        }
+
+        assert(pq.size() == reference.size());
+        if (!reference.empty()) {
+            assert(pq.top() == reference.back());
+            assert(pq.bottom() == reference.front());
+        }
+    }
+
+    const std::vector<int> vec { 4, 9, 1, 7, 3, 8 };
+    MinMaxPQ<int> built { vec.begin(), vec.end() };
+    assert(built.top() == 9 && built.bottom() == 1);
+
+    MinMaxPQ<int> bounded {};
+    for (int val : { 5, 1, 9, 3, 7, 2, 8 }) {
+        bounded.push_bounded(val, 4);
+    }
+    assert(bounded.size() == 4);
+    assert(not bounded.push_bounded(4, 4));  // less extreme than everything kept
+    const std::vector<int> expected { 9, 8, 7, 5 };
+    for ([[maybe_unused]] int val : expected) {
+        assert(bounded.top() == val);
+        bounded.pop();
+    }
+
+    std::cout << "testMinMax succeeded!" << std::endl;
+} // testMinMax()
+
+
 void testLargeUpdateElt() {
     std::cout << "Testing PairingPQ with a large update without popping..." << std::endl;
 
@@ -278,6 +1784,118 @@ void testHeapIntegrity() {
     }
 }
 
+// Test PairingPQ::markDirty/updateDirty with pointer elements whose
+// targets change in both directions.
+void testUpdateDirtyPairing() {
+    std::cout << "Testing PairingPQ markDirty/updateDirty..." << std::endl;
+
+    unsigned state = 11;
+    auto next = [&state]() {
+        state = state * 1103515245u + 12345u;
+        return state >> 8;
+    };
+
+    for (const std::size_t changes : { std::size_t { 1 }, std::size_t { 25 }, std::size_t { 600 } }) {
+        std::vector<int> values(1000);
+        for (int &val : values) {
+            val = static_cast<int>(next() % 100000);
+        }
+        PairingPQ<const int *, IntPtrComp> pq {};
+        std::vector<PairingPQ<const int *, IntPtrComp>::Node *> handles;
+        for (const int &val : values) {
+            handles.push_back(pq.addNode(&val));
+        }
+        // Pop a few so the heap has some shape before values change.
+        std::vector<bool> popped(values.size(), false);
+        for (int i = 0; i < 10; ++i) {
+            popped[static_cast<std::size_t>(pq.top() - values.data())] = true;
+            pq.pop();
+        }
+
+        for (std::size_t c = 0; c < changes; ++c) {
+            const std::size_t i = next() % values.size();
+            if (popped[i]) continue;
+            values[i] = static_cast<int>(next() % 100000);
+            pq.markDirty(handles[i]);
+        }
+        pq.updateDirty();
+
+        std::vector<int> expected;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (!popped[i]) expected.push_back(values[i]);
+        }
+        std::sort(expected.rbegin(), expected.rend());
+        assert(pq.size() == expected.size());
+        for ([[maybe_unused]] int val : expected) {
+            assert(*pq.top() == val);
+            pq.pop();
+        }
+    }
+
+    std::cout << "testUpdateDirtyPairing succeeded!" << std::endl;
+} // testUpdateDirtyPairing()
+
+
+// Test PairingPQ::updateElts with batches that raise and lower priorities,
+// name the root and nodes below other changed nodes, repeat nodes, and
+// change most of the heap (the rebuild path).
+void testUpdateEltsPairing() {
+    std::cout << "Testing PairingPQ::updateElts..." << std::endl;
+
+    unsigned state = 29;
+    auto next = [&state]() {
+        state = state * 1103515245u + 12345u;
+        return state >> 8;
+    };
+
+    for (const std::size_t changes : { std::size_t { 1 }, std::size_t { 40 }, std::size_t { 300 }, std::size_t { 900 } }) {
+        std::vector<int> values(1000);
+        PairingPQ<int> pq {};
+        std::vector<PairingPQ<int>::Node *> handles;
+        for (int &val : values) {
+            val = static_cast<int>(next() % 100000);
+            handles.push_back(pq.addNode(val));
+        }
+        // Pop a few so the heap has some shape before values change.
+        std::vector<bool> popped(values.size(), false);
+        for (int i = 0; i < 10; ++i) {
+            std::size_t top = 0;
+            while (popped[top] || values[top] != pq.top()) ++top;
+            popped[top] = true;
+            pq.pop();
+        }
+
+        std::size_t top = 0;
+        while (popped[top] || values[top] != pq.top()) ++top;
+        std::vector<std::pair<PairingPQ<int>::Node *, int>> batch;
+        for (std::size_t c = 0; c < changes; ++c) {
+            const std::size_t i = next() % values.size();
+            if (popped[i]) continue;
+            values[i] = static_cast<int>(next() % 100000);
+            batch.emplace_back(handles[i], values[i]);
+        }
+        // The old top, raised and then lowered in the same batch.
+        batch.emplace_back(handles[top], 200000);
+        values[top] = 5;
+        batch.emplace_back(handles[top], values[top]);
+        pq.updateElts(batch.begin(), batch.end());
+
+        std::vector<int> expected;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (!popped[i]) expected.push_back(values[i]);
+        }
+        std::sort(expected.rbegin(), expected.rend());
+        assert(pq.size() == expected.size());
+        for ([[maybe_unused]] int val : expected) {
+            assert(pq.top() == val);
+            pq.pop();
+        }
+    }
+
+    std::cout << "testUpdateEltsPairing succeeded!" << std::endl;
+} // testUpdateEltsPairing()
+
+
 void testUpdateEltPairing() {
     std::cout << "Testing PairingPQ::updateElt..." << std::endl;
 
@@ -315,6 +1933,78 @@ void testUpdateEltPairing() {
 
 
 
+// Randomized addNode/updateElt/pop workload for any PQ with the Node*
+// handle API (PairingPQ, RankPairingPQ), checked against a brute-force scan.
+template <template <typename...> typename PQ>
+void testHandleUpdates() {
+    std::cout << "Testing addNode/updateElt against a reference..." << std::endl;
+
+    PQ<int> pq {};
+    // Node* for the pointer-based heaps, an index for CompactPairingPQ.
+    using Handle = decltype(pq.addNode(0));
+    [[maybe_unused]] auto eltOf = [&pq](Handle handle) {
+        if constexpr (std::is_pointer<Handle>::value) {
+            return handle->getElt();
+        } else {
+            return pq.getElt(handle);
+        }
+    };
+    std::vector<Handle> handles;
+    std::vector<int> values;  // current value of handles[i], -1 once popped
+
+    unsigned state = 2024;
+    auto next = [&state]() {
+        state = state * 1103515245u + 12345u;
+        return state >> 8;
+    };
+
+    for (int round = 0; round < 5000; ++round) {
+        const unsigned op = next() % 10;
+        if (op < 4 || pq.empty()) {
+            const int val = static_cast<int>(next() % 100000);
+            handles.push_back(pq.addNode(val));
+            values.push_back(val);
+        } else if (op < 8) {
+            const std::size_t i = next() % handles.size();
+            if (values[i] < 0) continue;
+            const int val = values[i] + static_cast<int>(next() % 5000);
+            pq.updateElt(handles[i], val);
+            values[i] = val;
+            assert(eltOf(handles[i]) == val);
+        } else {
+            const int best = *std::max_element(values.begin(), values.end());
+            assert(pq.top() == best);
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (values[i] == best) {
+                    values[i] = -1;
+                    break;
+                }
+            }
+            pq.pop();
+        }
+    }
+
+    std::size_t live = 0;
+    for (int val : values) {
+        live += val >= 0;
+    }
+    assert(pq.size() == live);
+
+    std::vector<int> remaining;
+    for (int val : values) {
+        if (val >= 0) remaining.push_back(val);
+    }
+    std::sort(remaining.rbegin(), remaining.rend());
+    for ([[maybe_unused]] int val : remaining) {
+        assert(pq.top() == val);
+        pq.pop();
+    }
+    assert(pq.empty());
+
+    std::cout << "testHandleUpdates succeeded!" << std::endl;
+} // testHandleUpdates()
+
+
 // Test the pairing heap's range-based constructor, copy constructor,
 // copy-assignment operator, and destructor
 // TODO: Test other operations specific to this PQ type.
@@ -362,18 +2052,284 @@ void testPairing() {
         std::cout << "Calling destructors" << std::endl;
     } // block for testing destructors
 
+    {
+        PairingPQ<int, std::less<int>, CountingInstrument> counted;
+        // Descending pushes leave every node as a child of the root.
+        for (int i = 63; i >= 0; --i) {
+            counted.push(i);
+        }
+        counted.pop();
+        assert(counted.instrumentation().allocationCount() == 64);
+        assert(counted.instrumentation().rootChildHistogram().count() == 1);
+        assert(counted.instrumentation().rootChildHistogram().max() == 63);
+    }
+
     std::cout << "testPairing succeeded!" << std::endl;
 } // testPairing()
 
 
+// An object that embeds its own pairing-heap links.
+struct Task {
+    int priority = 0;
+    bool queued = false;
+    PairingHook<Task> hook;
+}; // Task
+
+struct TaskLess {
+    bool operator()(const Task &a, const Task &b) const {
+        return a.priority < b.priority;
+    } // operator()()
+}; // TaskLess
+
+
+// Test IntrusivePairingPQ against a reference: push, pop, updateElt and
+// erase on caller-owned objects, with no allocation inside the PQ.
+void testIntrusivePairing() {
+    std::cout << "Testing IntrusivePairingPQ..." << std::endl;
+
+    using TaskPQ = IntrusivePairingPQ<Task, &Task::hook, TaskLess, CountingInstrument>;
+    std::vector<Task> tasks(500);
+    TaskPQ pq {};
+
+    unsigned state = 281;
+    auto next = [&state]() {
+        state = state * 1103515245u + 12345u;
+        return state >> 8;
+    };
+    auto best = [&tasks]() {
+        const Task *result = nullptr;
+        for (const Task &task : tasks) {
+            if (task.queued && (!result || result->priority < task.priority)) result = &task;
+        }
+        return result;
+    };
+
+    for (int round = 0; round < 5000; ++round) {
+        Task &task = tasks[next() % tasks.size()];
+        const unsigned op = next() % 10;
+        if (!task.queued && op < 5) {
+            task.priority = static_cast<int>(next() % 100000);
+            task.queued = true;
+            pq.push(&task);
+        } else if (task.queued && op < 7) {
+            task.priority += static_cast<int>(next() % 5000);
+            pq.updateElt(&task);
+        } else if (task.queued && op < 8) {
+            pq.erase(&task);
+            task.queued = false;
+            assert(!pq.isLinked(&task));
+        } else if (!pq.empty()) {
+            [[maybe_unused]] const Task *expected = best();
+            assert(pq.top()->priority == expected->priority);
+            pq.top()->queued = false;
+            pq.pop();
+        }
+    }
+
+    std::size_t live = 0;
+    for (const Task &task : tasks) {
+        live += task.queued;
+        assert(pq.isLinked(&task) == task.queued);
+    }
+    assert(pq.size() == live);
+    assert(pq.instrumentation().allocationCount() == 0);
+
+    // Meld a second queue in, then scramble every priority and rebuild.
+    TaskPQ other {};
+    for (Task &task : tasks) {
+        if (!task.queued) {
+            task.priority = static_cast<int>(next() % 100000);
+            task.queued = true;
+            other.push(&task);
+        }
+    }
+    pq.meld(other);
+    assert(other.empty() && pq.size() == tasks.size());
+    for (Task &task : tasks) {
+        task.priority = static_cast<int>(next() % 100000);
+    }
+    pq.updatePriorities();
+
+    [[maybe_unused]] int previous = pq.top()->priority;
+    while (!pq.empty()) {
+        assert(pq.top()->priority <= previous);
+        previous = pq.top()->priority;
+        pq.pop();
+    }
+
+    // pop_above() compares the objects, not the pointers.
+    for (Task &task : tasks) {
+        task.priority = static_cast<int>(next() % 1000);
+        pq.push(&task);
+    }
+    Task threshold {};
+    threshold.priority = 800;
+    std::vector<Task *> above;
+    pq.pop_above(&threshold, std::back_inserter(above));
+    previous = 1000;
+    for ([[maybe_unused]] const Task *task : above) {
+        assert(task->priority > 800 && task->priority <= previous && !pq.isLinked(task));
+        previous = task->priority;
+    }
+    assert(!above.empty() && pq.top()->priority <= 800);
+    assert(pq.size() + above.size() == tasks.size());
+    pq.clear();
+
+    // The destructor unlinks whatever is left.
+    {
+        TaskPQ scoped { };
+        scoped.push(&tasks[0]);
+        scoped.push(&tasks[1]);
+    }
+    assert(tasks[0].hook.prev == nullptr && tasks[1].hook.prev == nullptr);
+
+    std::cout << "testIntrusivePairing succeeded!" << std::endl;
+} // testIntrusivePairing()
+
+
 // Run all tests for a particular PQ type.
 template <template <typename...> typename PQ>
 void testPriorityQueue() {
     testPrimitiveOperations<PQ>();
     testHiddenData<PQ>();
     testUpdatePriorities<PQ>();
+    testInstrumentation<PQ>();
+    testSnapshot<PQ>();
+    testDrain<PQ>();
 } // testPriorityQueue()
 
+// SortedPQ supports tombstones and dirty tracking; SmallPQ is its inline
+// fixed-capacity cousin.
+template <>
+void testPriorityQueue<SortedPQ>() {
+    testPrimitiveOperations<SortedPQ>();
+    testHiddenData<SortedPQ>();
+    testUpdatePriorities<SortedPQ>();
+    testInstrumentation<SortedPQ>();
+    testSnapshot<SortedPQ>();
+    testTombstones<SortedPQ>();
+    testUpdateDirty<SortedPQ>();
+    testDrain<SortedPQ>();
+    testRadixSort();
+    testSmallPQ();
+} // testPriorityQueue<SortedPQ>()
+
+// SequenceHeapPQ has no snapshots; it also gets a test big enough to merge.
+template <>
+void testPriorityQueue<SequenceHeapPQ>() {
+    testPrimitiveOperations<SequenceHeapPQ>();
+    testHiddenData<SequenceHeapPQ>();
+    testUpdatePriorities<SequenceHeapPQ>();
+    testInstrumentation<SequenceHeapPQ>();
+    testSequenceHeap();
+} // testPriorityQueue<SequenceHeapPQ>()
+
+// BatchParallelPQ is not instrumented and has no snapshots.
+template <>
+void testPriorityQueue<BatchParallelPQ>() {
+    testPrimitiveOperations<BatchParallelPQ>();
+    testHiddenData<BatchParallelPQ>();
+    testUpdatePriorities<BatchParallelPQ>();
+    testBatchParallel();
+} // testPriorityQueue<BatchParallelPQ>()
+
+// BinaryPQ adds replace_top/pushpop, which TopK builds on; LoserTree is
+// the merge-specialized alternative to replace_top.
+template <>
+void testPriorityQueue<BinaryPQ>() {
+    testPrimitiveOperations<BinaryPQ>();
+    testHiddenData<BinaryPQ>();
+    testUpdatePriorities<BinaryPQ>();
+    testInstrumentation<BinaryPQ>();
+    testReplaceTop<BinaryPQ>();
+    testSnapshot<BinaryPQ>();
+    testTombstones<BinaryPQ>();
+    testUpdateDirty<BinaryPQ>();
+    testDrain<BinaryPQ>();
+    testPushBatch();
+    testFastSift();
+    testTopK();
+    testLoserTree();
+    testSharedMemory();
+    testAllocators();
+    testPriorityExecutor<BinaryPQ>();
+    testFlatCombining<BinaryPQ>();
+} // testPriorityQueue<BinaryPQ>()
+
+// MinMaxPQ also serves the least extreme end.
+template <>
+void testPriorityQueue<MinMaxPQ>() {
+    testPrimitiveOperations<MinMaxPQ>();
+    testHiddenData<MinMaxPQ>();
+    testUpdatePriorities<MinMaxPQ>();
+    testInstrumentation<MinMaxPQ>();
+    testMinMax();
+} // testPriorityQueue<MinMaxPQ>()
+
+// RankPairingPQ shares PairingPQ's Node* handle API.
+template <>
+void testPriorityQueue<RankPairingPQ>() {
+    testPrimitiveOperations<RankPairingPQ>();
+    testHiddenData<RankPairingPQ>();
+    testUpdatePriorities<RankPairingPQ>();
+    testInstrumentation<RankPairingPQ>();
+    testHandleUpdates<RankPairingPQ>();
+
+    const std::vector<int> vec { 3, 1, 4, 1, 5 };
+    RankPairingPQ<int> ranked { vec.begin(), vec.end() };
+    RankPairingPQ<int> copy { ranked };
+    RankPairingPQ<int> assigned {};
+    assigned = copy;
+    ranked.pop();
+    assert(ranked.top() == 4 && copy.top() == 5 && assigned.size() == 5);
+} // testPriorityQueue<RankPairingPQ>()
+
+// CompactPairingPQ has PairingPQ's API with integer handles.
+template <>
+void testPriorityQueue<CompactPairingPQ>() {
+    testPrimitiveOperations<CompactPairingPQ>();
+    testHiddenData<CompactPairingPQ>();
+    testUpdatePriorities<CompactPairingPQ>();
+    testInstrumentation<CompactPairingPQ>();
+    testHandleUpdates<CompactPairingPQ>();
+    testPriorityExecutor<CompactPairingPQ>();
+
+    // Popped slots are reused, and a copy shares no storage.
+    CompactPairingPQ<int> pq {};
+    const auto first = pq.addNode(1);
+    pq.addNode(2);
+    pq.pop();
+    [[maybe_unused]] const auto reused = pq.addNode(3);
+    assert(reused != first && pq.size() == 2);
+    CompactPairingPQ<int> copy { pq };
+    copy.updateElt(first, 10);
+    assert(copy.top() == 10 && pq.top() == 3 && pq.getElt(first) == 1);
+} // testPriorityQueue<CompactPairingPQ>()
+
+// AdaptivePQ moves between the vector-backed engines on its own.
+template <>
+void testPriorityQueue<AdaptivePQ>() {
+    testPrimitiveOperations<AdaptivePQ>();
+    testHiddenData<AdaptivePQ>();
+    testUpdatePriorities<AdaptivePQ>();
+    testInstrumentation<AdaptivePQ>();
+    testAdaptive();
+} // testPriorityQueue<AdaptivePQ>()
+
+// PersistentPQ adds versioning on top of the usual interface.
+template <>
+void testPriorityQueue<PersistentPQ>() {
+    testPrimitiveOperations<PersistentPQ>();
+    testHiddenData<PersistentPQ>();
+    testUpdatePriorities<PersistentPQ>();
+    testInstrumentation<PersistentPQ>();
+    testPersistent();
+
+    const std::vector<int> vec { 3, 1, 4, 1, 5 };
+    PersistentPQ<int> built { vec.begin(), vec.end() };
+    assert(built.top() == 5 && built.size() == 5);
+} // testPriorityQueue<PersistentPQ>()
+
 // PairingPQ has some extra behavior we need to test in updateElement.
 // This template specialization handles that without changing the nice
 // uniform interface of testPriorityQueue.
@@ -382,9 +2338,19 @@ void testPriorityQueue<PairingPQ>() {
     testPrimitiveOperations<PairingPQ>();
     testHiddenData<PairingPQ>();
     testUpdatePriorities<PairingPQ>();
+    testInstrumentation<PairingPQ>();
+    testReplaceTop<PairingPQ>();
+    testSnapshot<PairingPQ>();
+    testDrain<PairingPQ>();
     testPairing();
     testHeapIntegrity();
     testUpdateEltPairing();
+    testUpdateDirtyPairing();
+    testUpdateEltsPairing();
+    testHandleUpdates<PairingPQ>();
+    testIntrusivePairing();
+    testPriorityExecutor<PairingPQ>();
+    testFlatCombining<PairingPQ>();
     testLargeUpdateElt();
     testVeryLargeUpdateElt();
 } // testPriorityQueue<PairingPQ>()
@@ -396,6 +2362,13 @@ int main() {
         PQType::Sorted,
         PQType::Binary,
         PQType::Pairing,
+        PQType::MinMax,
+        PQType::RankPairing,
+        PQType::Persistent,
+        PQType::CompactPairing,
+        PQType::Adaptive,
+        PQType::SequenceHeap,
+        PQType::BatchParallel,
     };
 
     std::cout << "PQ tester" << std::endl << std::endl;
@@ -430,6 +2403,34 @@ int main() {
         testPriorityQueue<PairingPQ>();
         break;
 
+    case PQType::MinMax:
+        testPriorityQueue<MinMaxPQ>();
+        break;
+
+    case PQType::RankPairing:
+        testPriorityQueue<RankPairingPQ>();
+        break;
+
+    case PQType::Persistent:
+        testPriorityQueue<PersistentPQ>();
+        break;
+
+    case PQType::CompactPairing:
+        testPriorityQueue<CompactPairingPQ>();
+        break;
+
+    case PQType::Adaptive:
+        testPriorityQueue<AdaptivePQ>();
+        break;
+
+    case PQType::SequenceHeap:
+        testPriorityQueue<SequenceHeapPQ>();
+        break;
+
+    case PQType::BatchParallel:
+        testPriorityQueue<BatchParallelPQ>();
+        break;
+
     
     default:
         std::cout << "Unrecognized PQ type " << pqType << " in main.\n"